@@ -0,0 +1,258 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GeneticPathBenchmarkCommandlet.h"
+#include "MyProject2.h"
+#include "GeneticSolver.h"
+#include "PathGraph.h"
+#include "PathSolver.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+
+UGeneticPathBenchmarkCommandlet::UGeneticPathBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+void UGeneticPathBenchmarkCommandlet::BuildRandomGeometricGraph(FPathGraph& Graph, int32 NumNodes, float AverageDegree, float Extent, FRandomStream& Random)
+{
+    TArray<FVector> Locations;
+    Locations.Reserve(NumNodes);
+    for (int32 i = 0; i < NumNodes; i++)
+    {
+        Locations.Emplace(Random.FRandRange(0.0f, Extent), Random.FRandRange(0.0f, Extent), 0.0f);
+    }
+    Graph.SetNodeLocations(Locations);
+
+    // Expected degree of a point in a uniform square is NumNodes * PI * R^2 / Extent^2
+    const float Radius = Extent * FMath::Sqrt(AverageDegree / (UE_PI * FMath::Max(NumNodes, 1)));
+    const float RadiusSquared = FMath::Square(Radius);
+
+    // Uniform grid with the link radius as cell size, only neighboring cells can hold partners
+    auto GetCell = [Radius](const FVector& Location)
+        {
+            return FIntPoint(FMath::FloorToInt(Location.X / Radius), FMath::FloorToInt(Location.Y / Radius));
+        };
+
+    TMap<FIntPoint, TArray<int32>> Grid;
+    for (int32 i = 0; i < NumNodes; i++)
+    {
+        Grid.FindOrAdd(GetCell(Locations[i])).Add(i);
+    }
+
+    TArray<FIntPoint> Links;
+    for (int32 i = 0; i < NumNodes; i++)
+    {
+        const FIntPoint Cell = GetCell(Locations[i]);
+        for (int32 DY = -1; DY <= 1; DY++)
+        {
+            for (int32 DX = -1; DX <= 1; DX++)
+            {
+                if (const TArray<int32>* Bucket = Grid.Find(Cell + FIntPoint(DX, DY)))
+                {
+                    for (int32 j : *Bucket)
+                    {
+                        if (j > i && FVector::DistSquared(Locations[i], Locations[j]) <= RadiusSquared)
+                        {
+                            Links.Emplace(i, j);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    Graph.BuildLinks(Links);
+}
+
+int32 UGeneticPathBenchmarkCommandlet::Main(const FString& Params)
+{
+    int32 NumNodes = 1000;
+    float AverageDegree = 8.0f;
+    float Extent = 10000.0f;
+    int32 NumRuns = 5;
+    int32 Seed = 1;
+    int32 Islands = 1;
+    int32 LocalSearchBudget = 0;
+    int32 ReplanLinks = 0;
+    FGeneticSolverSettings DefaultSettings;
+    int32 PopulationSize = DefaultSettings.PopulationSize;
+    FString SelectionName = StaticEnum<EGeneticSelectionType>()->GetNameStringByValue(static_cast<int64>(DefaultSettings.Selection));
+    FString SolverList = TEXT("Genetic,AStar,BidirectionalDijkstra,Hierarchical");
+    FString OutputPath;
+    FParse::Value(*Params, TEXT("Nodes="), NumNodes);
+    FParse::Value(*Params, TEXT("Degree="), AverageDegree);
+    FParse::Value(*Params, TEXT("Extent="), Extent);
+    FParse::Value(*Params, TEXT("Runs="), NumRuns);
+    FParse::Value(*Params, TEXT("Seed="), Seed);
+    FParse::Value(*Params, TEXT("Islands="), Islands);
+    FParse::Value(*Params, TEXT("LocalSearch="), LocalSearchBudget);
+    FParse::Value(*Params, TEXT("ReplanLinks="), ReplanLinks);
+    FParse::Value(*Params, TEXT("Population="), PopulationSize);
+    FParse::Value(*Params, TEXT("Selection="), SelectionName);
+    FParse::Value(*Params, TEXT("Solvers="), SolverList);
+    FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+    TArray<FString> SolverNames;
+    SolverList.ParseIntoArray(SolverNames, TEXT(","));
+    TArray<EPathSolverType> SolverTypes;
+    for (const FString& SolverName : SolverNames)
+    {
+        const int64 Value = StaticEnum<EPathSolverType>()->GetValueByNameString(SolverName.TrimStartAndEnd());
+        if (Value == INDEX_NONE)
+        {
+            UE_LOG(LogGeneticPath, Error, TEXT("Unknown solver %s in -Solvers."), *SolverName);
+            return 1;
+        }
+        SolverTypes.Add(static_cast<EPathSolverType>(Value));
+    }
+
+    const int64 SelectionValue = StaticEnum<EGeneticSelectionType>()->GetValueByNameString(SelectionName);
+    if (SelectionValue == INDEX_NONE)
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Unknown -Selection=%s."), *SelectionName);
+        return 1;
+    }
+    const EGeneticSelectionType Selection = static_cast<EGeneticSelectionType>(SelectionValue);
+
+    if (NumNodes < 2 || NumRuns < 1 || AverageDegree <= 0.0f || Extent <= 0.0f || SolverTypes.Num() == 0)
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Need -Nodes >= 2, -Runs >= 1, positive -Degree and -Extent and at least one -Solvers entry."));
+        return 1;
+    }
+
+    FRandomStream Random(Seed);
+    FPathGraph Graph;
+    const double BuildStartTime = FPlatformTime::Seconds();
+    BuildRandomGeometricGraph(Graph, NumNodes, AverageDegree, Extent, Random);
+    const double BuildSeconds = FPlatformTime::Seconds() - BuildStartTime;
+
+    // Solve corner to corner, the nodes closest to (0, 0) and (Extent, Extent)
+    int32 StartIndex = 0;
+    int32 EndIndex = 0;
+    const FVector FarCorner(Extent, Extent, 0.0f);
+    for (int32 i = 1; i < NumNodes; i++)
+    {
+        const FVector Location = Graph.GetNodeLocation(i);
+        if (Location.SizeSquared() < Graph.GetNodeLocation(StartIndex).SizeSquared())
+        {
+            StartIndex = i;
+        }
+        if (FVector::DistSquared(Location, FarCorner) < FVector::DistSquared(Graph.GetNodeLocation(EndIndex), FarCorner))
+        {
+            EndIndex = i;
+        }
+    }
+
+    UE_LOG(LogGeneticPath, Display, TEXT("Graph: %d nodes, %d links, built in %.2f ms, %.1f KB. Solving %d -> %d."),
+        Graph.GetNumNodes(), Graph.GetNumLinks(), BuildSeconds * 1000.0, Graph.GetAllocatedSize() / 1024.0, StartIndex, EndIndex);
+
+    FString Csv;
+    for (EPathSolverType SolverType : SolverTypes)
+    {
+        const FString SolverName = StaticEnum<EPathSolverType>()->GetNameStringByValue(static_cast<int64>(SolverType));
+        double TotalSeconds = 0.0;
+        double TotalSecondsToBest = 0.0;
+        double TotalPathCost = 0.0;
+        int64 TotalGenerations = 0;
+        int64 TotalEvaluations = 0;
+        int32 NumReachedGoal = 0;
+        for (int32 Run = 0; Run < NumRuns; Run++)
+        {
+            TUniquePtr<IPathSolver> Solver = MakePathSolver(SolverType, Graph);
+            FGeneticSolver* GeneticSolver = Solver->GetType() == EPathSolverType::Genetic ? static_cast<FGeneticSolver*>(Solver.Get()) : nullptr;
+            if (FGeneticSolverSettings* Settings = Solver->GetGeneticSettings())
+            {
+                Settings->IslandCount = Islands;
+                Settings->LocalSearchBudget = LocalSearchBudget;
+                Settings->PopulationSize = PopulationSize;
+                Settings->Selection = Selection;
+            }
+
+            std::atomic<bool> bCancelRequested(false);
+            const FPath Best = Solver->Solve(StartIndex, EndIndex, Seed + Run, bCancelRequested);
+            const bool bReachedGoal = Best.PathPoints.Num() > 0 && Best.PathPoints.Last() == EndIndex;
+            const float PathCost = bReachedGoal ? Graph.GetPathCost(Best.PathPoints) : 0.0f;
+
+            // Exact searches have no generations, their whole solve is the time to the best path
+            FGeneticSolveStats Stats;
+            if (GeneticSolver)
+            {
+                Stats = GeneticSolver->GetStats();
+            }
+            else
+            {
+                Stats.Seconds = Stats.SecondsToBest = Solver->GetLastSolveSeconds();
+                Stats.BestFitness = Best.Fitness;
+            }
+
+            // Break the best path and time how long the solver takes to recover from its last state
+            double ReplanSeconds = 0.0;
+            if (ReplanLinks > 0 && Best.PathPoints.Num() > 1)
+            {
+                TArray<FIntPoint> RemovedLinks;
+                for (int32 i = 0; i + 1 < Best.PathPoints.Num() && RemovedLinks.Num() < ReplanLinks; i += FMath::Max(1, (Best.PathPoints.Num() - 1) / ReplanLinks))
+                {
+                    if (Graph.IsValidLink(Best.PathPoints[i], Best.PathPoints[i + 1]))
+                    {
+                        RemovedLinks.Emplace(Best.PathPoints[i], Best.PathPoints[i + 1]);
+                    }
+                }
+
+                Graph.UpdateLinks(TConstArrayView<FIntPoint>(), RemovedLinks);
+                const double ReplanStartTime = FPlatformTime::Seconds();
+                const FPath Replanned = Solver->Replan(StartIndex, EndIndex, Seed + Run, bCancelRequested);
+                ReplanSeconds = FPlatformTime::Seconds() - ReplanStartTime;
+                Graph.UpdateLinks(RemovedLinks, TConstArrayView<FIntPoint>());
+
+                UE_LOG(LogGeneticPath, Display, TEXT("%s run %d: replan without %d links in %.2f ms (%.0f%% of the solve), goal %s"),
+                    *SolverName, Run, RemovedLinks.Num(), ReplanSeconds * 1000.0, Stats.Seconds > 0.0 ? 100.0 * ReplanSeconds / Stats.Seconds : 0.0,
+                    Replanned.PathPoints.Num() > 0 && Replanned.PathPoints.Last() == EndIndex ? TEXT("reached") : TEXT("missed"));
+            }
+
+            const double GenerationsPerSecond = Stats.Seconds > 0.0 ? Stats.Generations / Stats.Seconds : 0.0;
+            const double EvaluationsPerSecond = Stats.Seconds > 0.0 ? Stats.Evaluations / Stats.Seconds : 0.0;
+            UE_LOG(LogGeneticPath, Display, TEXT("%s run %d: %d generations in %.2f ms (%.0f gen/s, %.0f eval/s), best %f after %d generations / %.2f ms, cost %.1f, goal %s"),
+                *SolverName, Run, Stats.Generations, Stats.Seconds * 1000.0, GenerationsPerSecond, EvaluationsPerSecond,
+                Stats.BestFitness, Stats.GenerationsToBest, Stats.SecondsToBest * 1000.0, PathCost, bReachedGoal ? TEXT("reached") : TEXT("missed"));
+
+            // Exact searches always run to the end, they have no stop reason
+            const TCHAR* StopReason = GeneticSolver ? LexToString(Stats.StopReason) : TEXT("");
+            Csv += FString::Printf(TEXT("%d,%d,%d,%d,%d,%d,%d,%lld,%f,%f,%f,%d,%s,%f,%s,%d,%s,%f\n"),
+                NumNodes, Graph.GetNumLinks(), Islands, LocalSearchBudget, Seed + Run, Stats.Generations, Stats.GenerationsToBest, Stats.Evaluations,
+                Stats.Seconds, Stats.SecondsToBest, Stats.BestFitness, bReachedGoal ? 1 : 0, *SolverName, PathCost, *SelectionName, PopulationSize, StopReason, ReplanSeconds);
+
+            TotalSeconds += Stats.Seconds;
+            TotalSecondsToBest += Stats.SecondsToBest;
+            TotalPathCost += PathCost;
+            TotalGenerations += Stats.Generations;
+            TotalEvaluations += Stats.Evaluations;
+            NumReachedGoal += bReachedGoal ? 1 : 0;
+        }
+
+        UE_LOG(LogGeneticPath, Display, TEXT("%s summary: %.2f ms per solve, %.2f ms to converge, average cost %.1f, %.0f gen/s, %.0f eval/s, goal reached %d/%d"),
+            *SolverName, TotalSeconds * 1000.0 / NumRuns, TotalSecondsToBest * 1000.0 / NumRuns,
+            NumReachedGoal > 0 ? TotalPathCost / NumReachedGoal : 0.0,
+            TotalSeconds > 0.0 ? TotalGenerations / TotalSeconds : 0.0,
+            TotalSeconds > 0.0 ? TotalEvaluations / TotalSeconds : 0.0,
+            NumReachedGoal, NumRuns);
+    }
+
+    const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+    UE_LOG(LogGeneticPath, Display, TEXT("Peak memory %.1f MB"), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+
+    if (!OutputPath.IsEmpty())
+    {
+        // One row per run, header only for a new file, so nightly runs can keep appending
+        if (!IFileManager::Get().FileExists(*OutputPath))
+        {
+            Csv = TEXT("Nodes,Links,Islands,LocalSearchBudget,Seed,Generations,GenerationsToBest,Evaluations,Seconds,SecondsToBest,BestFitness,ReachedGoal,Solver,PathCost,Selection,PopulationSize,StopReason,ReplanSeconds\n") + Csv;
+        }
+        FFileHelper::SaveStringToFile(Csv, *OutputPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+    }
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Math/RandomStream.h"
+#include "GeneticPathBenchmarkCommandlet.generated.h"
+
+struct FPathGraph;
+
+/**
+ * Runs the path solvers headless on random geometric graphs and compares their latency and path cost.
+ *
+ * UnrealEditor-Cmd MyProject2.uproject -run=GeneticPathBenchmark -Nodes=2000 -Degree=8 -Runs=5
+ *
+ * Options: -Nodes, -Degree (average links per node), -Extent (side of the square the
+ * points are scattered in), -Runs, -Seed, -Islands, -LocalSearch (per-generation budget),
+ * -Population, -Selection=<EGeneticSelectionType name>, -ReplanLinks (links of the best path
+ * removed after each solve before timing a replan, 0 skips the replan),
+ * -Solvers=<comma separated EPathSolverType names, all exact and genetic by default>,
+ * -Output=<csv file to append to>
+ */
+UCLASS()
+class MYPROJECT2_API UGeneticPathBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UGeneticPathBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+
+    // Scatter points uniformly in a square and link every pair closer than the radius that gives AverageDegree
+    static void BuildRandomGeometricGraph(FPathGraph& Graph, int32 NumNodes, float AverageDegree, float Extent, FRandomStream& Random);
+};
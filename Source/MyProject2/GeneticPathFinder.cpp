@@ -1,539 +1,909 @@
 #include "GeneticPathFinder.h"
+#include "MyProject2.h"
+#include "GeneticPathSubsystem.h"
+#include "PathActorRegistry.h"
+#include "PathDebugDraw.h"
+#include "PathGraphBake.h"
+#include "Algo/SortBy.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryWriter.h"
 #include "Engine/World.h"
-#include "Kismet/GameplayStatics.h"
-#include "DrawDebugHelpers.h"
+#include "Components/LineBatchComponent.h"
+#include "Components/PrimitiveComponent.h"
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "Math/Vector.h"
-#include "Math/RandomStream.h"
-#include "Algo/Unique.h"
+#include "Async/ParallelFor.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 #include "Containers/Array.h"
 
-// Defines maximum population size and mutation rate
-#define POPULATION_SIZE 20
-#define MUTATION_RATE 0.05f
-#define MAX_GENERATIONS 1000
+DECLARE_CYCLE_STAT(TEXT("Define Links"), STAT_GeneticPath_DefineLinks, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Update Links"), STAT_GeneticPath_UpdateLinks, STATGROUP_GeneticPath);
 
 // Sets default values
 AGeneticPathFinder::AGeneticPathFinder()
 {
     PrimaryActorTick.bCanEverTick = true;
+    ResetBarrierCollision();
 }
 
 // Called when the game starts or when spawned
 void AGeneticPathFinder::BeginPlay()
 {
     Super::BeginPlay();
-    TArray<AActor*> StartActors;
-    TArray<AActor*> EndActors;
 
-    // Find actors with tags "StartPoint" and "EndPoint"
-    UGameplayStatics::GetAllActorsWithTag(GetWorld(), "StartPoint", StartActors);
-    UGameplayStatics::GetAllActorsWithTag(GetWorld(), "EndPoint", EndActors);
+    // Lines are in world space, so the component needs no attachment
+    DebugLines = NewObject<ULineBatchComponent>(this, TEXT("PathDebugLines"));
+    DebugLines->RegisterComponent();
 
-    StartActor = StartActors[0]; // Take the first actor (assuming only one "StartPoint")
-    EndActor = EndActors[0]; // Take the first actor (assuming only one "EndPoint")
+    UPathActorRegistry* Registry = GetWorld()->GetSubsystem<UPathActorRegistry>();
+    if (!Registry)
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("No path actor registry in world %s, the path finder stays idle."), *GetWorld()->GetName());
+        return;
+    }
+
+    // The registry saw every level actor before any BeginPlay ran
+    StartActor = Registry->GetFirstActor(UPathActorRegistry::StartPointTag); // Assuming only one "StartPoint"
+    EndActor = Registry->GetFirstActor(UPathActorRegistry::EndPointTag); // Assuming only one "EndPoint"
     DefineLinks();
-    StartGeneticAlgorithm();
+    StartGeneticAlgorithmAsync();
+
+    // Barriers spawned later are picked up here, moves and destruction through RegisterBarrier
+    ActorRegisteredHandle = Registry->OnActorRegistered.AddUObject(this, &AGeneticPathFinder::OnActorRegistered);
+}
+
+void AGeneticPathFinder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    // The task captures this actor, so it has to be finished before we go away
+    CancelGeneticAlgorithm();
+    if (SolveHandle.IsValid())
+    {
+        SolveHandle.Task.Wait();
+        SolveHandle.Reset();
+    }
+
+    if (UPathActorRegistry* Registry = GetWorld()->GetSubsystem<UPathActorRegistry>())
+    {
+        Registry->OnActorRegistered.Remove(ActorRegisteredHandle);
+    }
+    UnregisterBarriers();
+
+    Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
 void AGeneticPathFinder::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
+
+    // Before a finished solve resets the handle, so its last usage sample is still drawn
+    UpdateDebugDraw();
+
+    // Hand out the latest improvement of a running solve before its final result
+    FPath ImprovedPath;
+    if (SolveHandle.Progress.IsValid() && SolveHandle.Progress->Consume(ImprovedPath) && !SolveHandle.IsCancelled())
+    {
+        UE_LOG(LogGeneticPath, Verbose, TEXT("Improved path (fitness %f): %s"), ImprovedPath.Fitness, *ImprovedPath.ToString());
+        VisualizePath(ImprovedPath);
+        OnPathImproved.Broadcast(ImprovedPath);
+    }
+
+    // Collect the result of a finished background solve on the game thread
+    if (SolveHandle.IsCompleted())
+    {
+        const bool bCancelled = SolveHandle.IsCancelled();
+        FPath Result = MoveTemp(SolveHandle.Task.GetResult());
+        SolveHandle.Reset();
+
+        // A cancelled solve is usually one a barrier change stopped, its link update runs below this same tick
+        if (bCancelled)
+        {
+            UE_LOG(LogGeneticPath, Log, TEXT("Genetic solve was cancelled."));
+        }
+        else
+        {
+            BestPath = MoveTemp(Result);
+            UE_LOG(LogGeneticPath, Log, TEXT("Best path: %s"), *BestPath.ToString());
+            VisualizePath(BestPath);
+            OnPathSolved.Broadcast(BestPath);
+        }
+    }
+
+    UpdateLinksNearBarriers();
 }
 
-void AGeneticPathFinder::DefineLinks()
+void AGeneticPathFinder::StartGeneticAlgorithmAsync()
 {
-        UE_LOG(LogTemp, Warning, TEXT("DefineLinks called!"));
+    LaunchSolve(false);
+}
 
-        // Get all point nodes
-        UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActor::StaticClass(), PointNodes);
+void AGeneticPathFinder::ReplanAsync(AActor* NewStartActor)
+{
+    if (NewStartActor)
+    {
+        StartActor = NewStartActor;
+    }
 
-        // Filter only BP_PointNode actors (assuming you've tagged them with "Point")
-        PointNodes = PointNodes.FilterByPredicate([](AActor* Actor)
-            {
-                return Actor->ActorHasTag("Point");
-            });
-        UE_LOG(LogTemp, Warning, TEXT("Found %d Point Nodes."), PointNodes.Num());
+    // A running solve is cancelled, its population is what the replan repairs
+    LaunchSolve(true);
+}
 
-        // Get all barriers
-        TArray<AActor*> Barriers;
-        UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActor::StaticClass(), Barriers);
+void AGeneticPathFinder::LaunchSolve(bool bWarmStart)
+{
+    // Only one solve per actor at a time, it owns the solver's population
+    CancelGeneticAlgorithm();
+    if (SolveHandle.IsValid())
+    {
+        SolveHandle.Task.Wait();
+        SolveHandle.Reset();
+    }
 
-        // Filter for only the barriers
-        Barriers = Barriers.FilterByPredicate([](AActor* Actor)
+    // Resolve everything that needs the actors here, on the game thread
+    StartIndex = PointNodes.IndexOfByKey(StartActor);
+    EndIndex = PointNodes.IndexOfByKey(EndActor);
+
+    // A zero seed picks a fresh one per solve, logged so the run can be reproduced
+    const int32 Seed = RandomSeed != 0 ? RandomSeed : FMath::Rand();
+
+    TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> CancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+    SolveHandle.CancelFlag = CancelFlag;
+    const EPathSolverType ResolvedSolverType = ResolvePathSolverType(SolverType, LinkGraph);
+    UE_LOG(LogGeneticPath, Log, TEXT("Starting %s %s with seed %d."), *UEnum::GetDisplayValueAsText(ResolvedSolverType).ToString(), bWarmStart ? TEXT("replan") : TEXT("solve"), Seed);
+    if (!Solver || Solver->GetType() != ResolvedSolverType)
+    {
+        Solver = MakePathSolver(ResolvedSolverType, LinkGraph);
+    }
+    if (FGeneticSolverSettings* Settings = Solver->GetGeneticSettings())
+    {
+        Settings->PopulationSize = PopulationSize;
+        Settings->MutationRate = MutationRate;
+        Settings->MaxGenerations = MaxGenerations;
+        Settings->Selection = Selection;
+        Settings->TournamentSize = TournamentSize;
+        Settings->MaxPathLength = MaxPathLength;
+        Settings->IslandCount = IslandCount;
+        Settings->MigrationInterval = MigrationInterval;
+        Settings->MigrantCount = MigrantCount;
+        Settings->LocalSearchBudget = LocalSearchBudget;
+        Settings->TimeLimitSeconds = TimeLimitSeconds;
+        Settings->TargetFitness = TargetFitness;
+        Settings->ConvergenceWindow = ConvergenceWindow;
+        Settings->ConvergenceTolerance = ConvergenceTolerance;
+        Settings->MinDiversity = MinDiversity;
+    }
+
+    // Improvements are only published while someone listens or watches, the solver then copies its best path out
+    Solver->OnProgress.Unbind();
+    TSharedPtr<FGeneticSolveProgress, ESPMode::ThreadSafe> Progress = MakeShared<FGeneticSolveProgress, ESPMode::ThreadSafe>();
+    if (OnPathImproved.IsBound() || bDrawBestPath)
+    {
+        SolveHandle.Progress = Progress;
+        Solver->OnProgress.BindLambda([Progress](const FPath& Path)
             {
-                return Actor->ActorHasTag("Barrier");
+                Progress->Publish(Path);
             });
-        UE_LOG(LogTemp, Warning, TEXT("Found %d Barriers."), Barriers.Num());
+    }
 
-        // Find valid links
-        for (int32 i = 0; i < PointNodes.Num(); i++)
+    // The usage heatmap samples the GA's islands on the solving thread, at most once per interval
+    if (ResolvedSolverType == EPathSolverType::Genetic)
+    {
+        FGeneticSolver* GeneticSolver = static_cast<FGeneticSolver*>(Solver.Get());
+        GeneticSolver->OnPopulationProgress.Unbind();
+        if (bDrawEdgeUsage)
         {
-            for (int32 j = i + 1; j < PointNodes.Num(); j++) // Avoid redundant checks
-            {
-                UE_LOG(LogTemp, Warning, TEXT("Checking link between %d and %d"), i, j);
-                FVector Start = PointNodes[i]->GetActorLocation();
-                FVector End = PointNodes[j]->GetActorLocation();
+            SolveHandle.Progress = Progress;
+            GeneticSolver->OnPopulationProgress.BindLambda([Progress, Graph = &LinkGraph, Interval = EdgeUsageInterval, LastSampleTime = 0.0](TConstArrayView<FPathPopulation> Islands) mutable
+                {
+                    const double Now = FPlatformTime::Seconds();
+                    if (Now - LastSampleTime < Interval)
+                    {
+                        return;
+                    }
+                    LastSampleTime = Now;
 
-                // Create a collision query parameters instance
-                FCollisionQueryParams CollisionParams;
+                    TArray<int32> Usage;
+                    FPathDebugDraw::CountEdgeUsage(*Graph, Islands, Usage);
+                    Progress->PublishEdgeUsage(MoveTemp(Usage));
+                });
+        }
+    }
 
-                // Add only the point nodes to the ignored actors list to avoid hitting them
-                TArray<AActor*> IgnoredActors = { PointNodes[i], PointNodes[j] };
+    // The solver and graph outlive the task: EndPlay waits for it
+    SolveHandle.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [SolverPtr = Solver.Get(), Start = StartIndex, End = EndIndex, Seed, bWarmStart, CancelFlag]()
+        {
+            return bWarmStart ? SolverPtr->Replan(Start, End, Seed, *CancelFlag) : SolverPtr->Solve(Start, End, Seed, *CancelFlag);
+        });
+}
 
-                // Add barriers to the collision query to ensure they can be hit by the trace
-                CollisionParams.AddIgnoredActors(IgnoredActors);
+void AGeneticPathFinder::CancelGeneticAlgorithm()
+{
+    SolveHandle.Cancel();
+}
 
-                // Perform line trace between the points
-                FHitResult HitResult;
-                if (GetWorld()->LineTraceSingleByChannel(HitResult, Start, End, ECC_Visibility, CollisionParams))
-                {
-                    // If we hit something, check if it's a barrier
-                    if (AActor* HitActor = HitResult.GetActor())
-                    {
-                        if (HitActor->ActorHasTag("Barrier"))
-                        {
-                            UE_LOG(LogTemp, Warning, TEXT("Path is blocked by Barrier: %s"), *HitActor->GetName());
-                            continue; // Skip this link if blocked by a barrier
-                        }
-                    }
-                }
+void AGeneticPathFinder::DefineLinks()
+{
+        TRACE_CPUPROFILER_EVENT_SCOPE(AGeneticPathFinder::DefineLinks);
+        SCOPE_CYCLE_COUNTER(STAT_GeneticPath_DefineLinks);
 
-                // If no block was found, consider the link valid
-                UE_LOG(LogTemp, Warning, TEXT("Found valid Link between %d and %d"), i, j);
-                ValidLinks.FindOrAdd(i).Add(j);
-                ValidLinks.FindOrAdd(j).Add(i);
-                // Debug line for visualization
-                //DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 10.0f);
-            }
+        UE_LOG(LogGeneticPath, Log, TEXT("DefineLinks called!"));
+
+        const TArray<AActor*> Barriers = GatherLinkActors();
+
+        // Barrier channels are collected here so the trace workers never look at tags
+        UnregisterBarriers();
+        for (AActor* Barrier : Barriers)
+        {
+            RegisterBarrier(Barrier);
         }
-        for (int i = 0; i < ValidLinks.Num(); i++) {
-            ValidLinks[i].Sort();
-            ValidLinks[i].SetNum(Algo::Unique(ValidLinks[i]));  // Remove duplicates
+
+        // A bake of the same layout has exactly the links the traces would find
+        const uint64 LayoutHash = ComputeLayoutHash(Barriers);
+        const FString BakePath = FPathGraphBake::GetBakePath(GetWorld());
+        if (bUseBakedLinkGraph && FPathGraphBake::Load(BakePath, LayoutHash, LinkGraph))
+        {
+            UE_LOG(LogGeneticPath, Log, TEXT("Loaded %d valid Links from %s."), LinkGraph.GetNumLinks(), *BakePath);
         }
-        for (const TPair<int32, TArray<int32>>& LinkPair : ValidLinks)
+        else
         {
-            FString LinkList = FString::Printf(TEXT("Point %d is linked to: "), LinkPair.Key);
+            TraceAllLinks();
+#if WITH_EDITOR
+            if (bUseBakedLinkGraph)
+            {
+                FPathGraphBake::Save(BakePath, LinkGraph, LayoutHash);
+            }
+#endif
+        }
+        PublishLinkGraph();
+
+        // Skip the per-point dump unless someone will see it
+        for (int32 Point = 0; Point < LinkGraph.GetNumNodes() && UE_LOG_ACTIVE(LogGeneticPath, VeryVerbose); Point++)
+        {
+            FString LinkList = FString::Printf(TEXT("Point %d is linked to: "), Point);
 
             // Iterate over the array of linked points and append them to the string
-            for (int32 Link : LinkPair.Value)
+            for (int32 Link : LinkGraph.GetLinks(Point))
             {
                 LinkList += FString::Printf(TEXT("%d "), Link);
             }
 
             // Log the result
-            UE_LOG(LogTemp, Warning, TEXT("%s"), *LinkList);
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("%s"), *LinkList);
         }
 
 }
 
-// Fitness Function: Determines how good a path is
-float AGeneticPathFinder::CalculateFitness(const FPath& Path)
+TArray<AActor*> AGeneticPathFinder::GatherLinkActors()
 {
-    if (Path.PathPoints.Num() < 2)
-        return 0.0f;
+        // Point and barrier actors are looked up by tag, no pass over the world's actors
+        const UPathActorRegistry* Registry = GetWorld()->GetSubsystem<UPathActorRegistry>();
+        if (!Registry)
+        {
+            UE_LOG(LogGeneticPath, Error, TEXT("No path actor registry in world %s, no points to link."), *GetWorld()->GetName());
+            PointNodes.Reset();
+            LinkGraph.SetNodeLocations(TArray<FVector>());
+            BuildLinkGrid();
+            return TArray<AActor*>();
+        }
 
-    // Get Start and End points
-   
-    //if (StartActors.Num() == 0 || EndActors.Num() == 0)
-    //{
-    //    UE_LOG(LogTemp, Warning, TEXT("StartPoint or EndPoint actors not found!"));
-    //    return 0.0f; // Return a default value or handle the error as appropriate
-    //}
+        // Get all point nodes (BP_PointNode actors tagged with "Point")
+        PointNodes = Registry->GetActors(UPathActorRegistry::PointTag);
 
-    FVector StartLocation = StartActor->GetActorLocation();
-    FVector EndLocation = EndActor->GetActorLocation();
+        // Registration order is not stable between loads, names are
+        Algo::SortBy(PointNodes, [](const AActor* Actor) { return Actor->GetFName(); }, FNameLexicalLess());
+        UE_LOG(LogGeneticPath, Log, TEXT("Found %d Point Nodes."), PointNodes.Num());
 
-    // Calculate path length and deviation from goal
-    float PathLength = 0.0f;
-    for (int i = 0; i < Path.PathPoints.Num() - 1; ++i)
-    {
-        FVector Current = PointNodes[Path.PathPoints[i]]->GetActorLocation();
-        FVector Next = PointNodes[Path.PathPoints[i + 1]]->GetActorLocation();
-        PathLength += FVector::Dist(Current, Next);
-    }
+        // Snapshot point locations into the graph, nothing after this reads the actors' transforms
+        TArray<FVector> Locations;
+        Locations.Reserve(PointNodes.Num());
+        for (AActor* Node : PointNodes)
+        {
+            Locations.Add(Node->GetActorLocation());
+        }
+        LinkGraph.SetNodeLocations(Locations);
+        BuildLinkGrid();
 
-    // Calculate the distance from the end point
-    FVector LastPoint = PointNodes[Path.PathPoints.Last()]->GetActorLocation();
-    float DistanceToEnd = FVector::Dist(LastPoint, EndLocation);
+        // Get all barriers
+        TArray<AActor*> Barriers = Registry->GetActors(UPathActorRegistry::BarrierTag);
+        Algo::SortBy(Barriers, [](const AActor* Actor) { return Actor->GetFName(); }, FNameLexicalLess());
+        UE_LOG(LogGeneticPath, Log, TEXT("Found %d Barriers."), Barriers.Num());
 
-    // Fitness: shorter path length and closer to the goal
-    return 1.0f / (PathLength + DistanceToEnd);  // Inversely proportional to path length + distance to goal
+        return Barriers;
 }
 
-// Create a random path
-FPath AGeneticPathFinder::GenerateRandomPath()
+uint64 AGeneticPathFinder::ComputeLayoutHash(TConstArrayView<AActor*> Barriers) const
 {
-    FPath NewPath;
-    
-    // Randomly select points (avoid the start and end points)
-    int32 StartIndex = PointNodes.IndexOfByKey(StartActor);
-    int32 EndIndex = PointNodes.IndexOfByKey(EndActor);
+    TArray<uint8> Layout;
+    FMemoryWriter Writer(Layout);
+
+    int32 FormatVersion = FPathGraphBake::FormatVersion;
+    float LinkCutoff = MaxLinkDistance;
+    Writer << FormatVersion << LinkCutoff;
+
+    // The agent shape decides which links fit and the clearance each one stores
+    float Radius = AgentRadius;
+    float HalfHeight = AgentHalfHeight;
+    float ClearanceLimit = MaxClearance;
+    int32 ClearanceSteps = ClearanceSearchSteps;
+    Writer << Radius << HalfHeight << ClearanceLimit << ClearanceSteps;
+
+    // Points in graph order, so a renamed point that moves an index also changes the hash
+    for (AActor* Node : PointNodes)
+    {
+        FVector Location = Node->GetActorLocation();
+        Writer << Location;
+    }
 
-    
-    if (StartIndex == INDEX_NONE || EndIndex == INDEX_NONE)
+    for (AActor* Barrier : Barriers)
     {
-        UE_LOG(LogTemp, Error, TEXT("Start or End actor not found in PointNodes! StartIndex: %d, EndIndex: %d"), StartIndex, EndIndex);
-        return NewPath;  // Handle the error (possibly exit early)
+        FTransform Transform = Barrier->GetActorTransform();
+        FBox Bounds = Barrier->GetComponentsBoundingBox(true);
+        Writer << Transform << Bounds;
     }
 
-    UE_LOG(LogTemp, Warning, TEXT("Generating path from Start Index: %d to End Index: %d"), StartIndex, EndIndex);
+    return CityHash64(reinterpret_cast<const char*>(Layout.GetData()), Layout.Num());
+}
 
-    int32 CurrentIndex = StartIndex;
-    TSet<int32> VisitedPoints; // Track points that have already been added to the path
-    VisitedPoints.Add(StartIndex);
-    NewPath.PathPoints.Add(StartIndex);
-    while (CurrentIndex != EndIndex)
-    {
-        TArray<int32>& Links = ValidLinks.FindChecked(CurrentIndex);
+void AGeneticPathFinder::TraceAllLinks()
+{
+        TRACE_CPUPROFILER_EVENT_SCOPE(AGeneticPathFinder::TraceAllLinks);
 
-        if (Links.Num() == 0)
+        const int32 NumNodes = LinkGraph.GetNumNodes();
+
+        // With a max link distance, points are bucketed into a uniform grid of that cell size
+        // so only pairs in neighboring cells are ever traced
+        const bool bUseLinkCutoff = MaxLinkDistance > 0.0f;
+        const float MaxLinkDistanceSquared = FMath::Square(MaxLinkDistance);
+        if (LinkGridCellSize != MaxLinkDistance)
         {
-            UE_LOG(LogTemp, Warning, TEXT("No valid links found for point %d!"), CurrentIndex);
-            break;
+            BuildLinkGrid();
         }
 
-        // Filter out already visited points
-        TArray<int32> UnvisitedLinks = Links.FilterByPredicate([&](int32 Point) {
-            return !VisitedPoints.Contains(Point);
-            });
+        // Trace one row of the pair matrix per task, each row only keeps partners j > i with their clearance
+        TArray<TArray<TPair<int32, float>>> RowLinks;
+        RowLinks.SetNum(NumNodes);
+        ParallelFor(NumNodes, [&](int32 i)
+            {
+                TArray<TPair<int32, float>>& Row = RowLinks[i];
+                float Clearance = 0.0f;
+                if (!bUseLinkCutoff)
+                {
+                    for (int32 j = i + 1; j < NumNodes; j++) // Avoid redundant checks
+                    {
+                        if (TraceLink(i, j, Clearance))
+                        {
+                            Row.Emplace(j, Clearance);
+                        }
+                    }
+                    return;
+                }
 
-        if (UnvisitedLinks.Num() == 0)
+                const FIntVector Cell = GetLinkCell(LinkGraph.GetNodeLocation(i));
+                for (int32 DZ = -1; DZ <= 1; DZ++)
+                {
+                    for (int32 DY = -1; DY <= 1; DY++)
+                    {
+                        for (int32 DX = -1; DX <= 1; DX++)
+                        {
+                            const TArray<int32>* Bucket = LinkGrid.Find(Cell + FIntVector(DX, DY, DZ));
+                            if (!Bucket)
+                            {
+                                continue;
+                            }
+
+                            for (int32 j : *Bucket)
+                            {
+                                if (j > i && FMath::Square(LinkGraph.GetSegmentLength(i, j)) <= MaxLinkDistanceSquared && TraceLink(i, j, Clearance))
+                                {
+                                    Row.Emplace(j, Clearance);
+                                }
+                            }
+                        }
+                    }
+                }
+
+                // Keep the same link order as the brute-force pass
+                Algo::SortBy(Row, &TPair<int32, float>::Key);
+            }, EParallelForFlags::Unbalanced);
+
+        // Find valid links, each unordered pair is recorded once with i < j
+        TArray<FIntPoint> Links;
+        TArray<float> Clearances;
+        for (int32 i = 0; i < NumNodes; i++)
         {
-            UE_LOG(LogTemp, Warning, TEXT("No unvisited links available for point %d! Terminating."), CurrentIndex);
-            break;
+            for (const TPair<int32, float>& Link : RowLinks[i])
+            {
+                Links.Emplace(i, Link.Key);
+                Clearances.Add(Link.Value);
+            }
         }
+        UE_LOG(LogGeneticPath, Log, TEXT("Found %d valid Links."), Links.Num());
 
-        // Randomly select the next point from unvisited links
-        int32 NextIndex = UnvisitedLinks[FMath::RandRange(0, UnvisitedLinks.Num() - 1)];
+        LinkGraph.BuildLinks(Links, TConstArrayView<float>(), Clearances);
+}
 
-        NewPath.PathPoints.Add(NextIndex);
-        VisitedPoints.Add(NextIndex); // Mark the point as visited
-        
-        UE_LOG(LogTemp, Warning, TEXT("Added Point %d to Path"), NextIndex);
+void AGeneticPathFinder::BuildLinkGrid()
+{
+    LinkGrid.Reset();
+    LinkGridCellSize = MaxLinkDistance;
+    if (LinkGridCellSize <= 0.0f)
+    {
+        return;
+    }
 
-        CurrentIndex = NextIndex; // Move to the next point
+    for (int32 Point = 0; Point < LinkGraph.GetNumNodes(); Point++)
+    {
+        LinkGrid.FindOrAdd(GetLinkCell(LinkGraph.GetNodeLocation(Point))).Add(Point);
     }
-    UE_LOG(LogTemp, Warning, TEXT("new generated path from generator:"));
-    LogPath(NewPath);
-    return NewPath;
 }
 
-
-
-// Select two paths for crossover
-void AGeneticPathFinder::SelectParents(FPath& Parent1, FPath& Parent2)
+FIntVector AGeneticPathFinder::GetLinkCell(const FVector& Location) const
 {
-    int32 Parent1Index = FMath::RandRange(0, Population.Num() - 1);
-    int32 Parent2Index = FMath::RandRange(0, Population.Num() - 1);
-
-    Parent1 = Population[Parent1Index];
-    Parent2 = Population[Parent2Index];
+    return FIntVector(
+        FMath::FloorToInt(Location.X / LinkGridCellSize),
+        FMath::FloorToInt(Location.Y / LinkGridCellSize),
+        FMath::FloorToInt(Location.Z / LinkGridCellSize));
 }
 
-// Crossover function
-FPath AGeneticPathFinder::Crossover(const FPath& Parent1, const FPath& Parent2)
+#if WITH_EDITOR
+void AGeneticPathFinder::BakeLinkGraph()
 {
-    FPath Child;
+    TRACE_CPUPROFILER_EVENT_SCOPE(AGeneticPathFinder::BakeLinkGraph);
 
-    // Ensure both parents have valid paths
-    if (Parent1.PathPoints.Num() == 0 || Parent2.PathPoints.Num() == 0)
+    // Runs on the editor world's actor, which never begins play, so the registry is filled here
+    // and barriers are only collected, not registered with this actor
+    UPathActorRegistry* Registry = GetWorld()->GetSubsystem<UPathActorRegistry>();
+    if (!Registry)
     {
-        UE_LOG(LogTemp, Error, TEXT("One of the parents has an empty path!"));
-        return Child;  // Return empty path if either parent is invalid
+        UE_LOG(LogGeneticPath, Error, TEXT("No path actor registry in world %s, nothing to bake."), *GetWorld()->GetName());
+        return;
     }
+    Registry->RegisterLevelActors();
+    const TArray<AActor*> Barriers = GatherLinkActors();
+    ResetBarrierCollision();
+    for (AActor* Barrier : Barriers)
+    {
+        AddBarrierCollision(Barrier);
+    }
+
+    TraceAllLinks();
+    FPathGraphBake::Save(FPathGraphBake::GetBakePath(GetWorld()), LinkGraph, ComputeLayoutHash(Barriers));
+}
+#endif
 
-    // Ensure the crossover point is within bounds for both parents
-    int32 CrossoverPoint = FMath::RandRange(1, FMath::Min(Parent1.PathPoints.Num(), Parent2.PathPoints.Num()) - 2); // Avoid endpoints
+void AGeneticPathFinder::VisualizePath(const FPath& Path)
+{
+    if (!bDrawBestPath || !DebugLines)
+    {
+        return;
+    }
 
-    // Take the first part from Parent1
-    Child.PathPoints.Append(Parent1.PathPoints.GetData(), CrossoverPoint);
+    // Replaces the previous path in one batch instead of one debug line per segment
+    FPathDebugDraw::DrawPath(*DebugLines, LinkGraph, Path.PathPoints);
+}
 
-    // Validate transition from Parent1's last point to Parent2's first point (at crossover)
-    int32 TransitionStart = Child.PathPoints.Last();
-    int32 TransitionEnd = Parent2.PathPoints[CrossoverPoint];
+void AGeneticPathFinder::UpdateDebugDraw()
+{
+    if (!DebugLines)
+    {
+        return;
+    }
 
-    if (!IsValidLink(TransitionStart, TransitionEnd))
+    // Only a new graph version redraws the links
+    const uint32 GraphVersion = bDrawLinkGraph ? LinkGraph.GetVersion() : 0;
+    if (GraphVersion != DrawnGraphVersion)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Invalid transition detected between %d and %d at crossover, fixing..."), TransitionStart, TransitionEnd);
-        const TArray<int32>* ValidStartLinks = ValidLinks.Find(TransitionStart);
-        if (ValidStartLinks && ValidStartLinks->Num() > 0)
+        if (bDrawLinkGraph)
         {
-            // Replace the first point of Parent2's segment with a valid link
-            TransitionEnd = (*ValidStartLinks)[FMath::RandRange(0, ValidStartLinks->Num() - 1)];
+            FPathDebugDraw::DrawGraph(*DebugLines, LinkGraph);
         }
+        else
+        {
+            DebugLines->ClearBatch(FPathDebugDraw::GraphBatch);
+        }
+        DrawnGraphVersion = GraphVersion;
     }
 
-    // Append the (adjusted) second part from Parent2
-    Child.PathPoints.Add(TransitionEnd);
-    Child.PathPoints.Append(Parent2.PathPoints.GetData() + CrossoverPoint + 1, Parent2.PathPoints.Num() - CrossoverPoint - 1);
+    if (bDrawEdgeUsage && SolveHandle.Progress.IsValid() && SolveHandle.Progress->ConsumeEdgeUsage(EdgeUsage))
+    {
+        FPathDebugDraw::DrawEdgeUsage(*DebugLines, LinkGraph, EdgeUsage);
+    }
+}
+void AGeneticPathFinder::RegisterBarrier(AActor* Barrier)
+{
+    AddBarrierCollision(Barrier);
+    BarrierBounds.Add(Barrier, Barrier->GetComponentsBoundingBox(true));
+    Barrier->OnDestroyed.AddDynamic(this, &AGeneticPathFinder::OnBarrierDestroyed);
 
-    // Validate the entire child path to ensure all links are valid
-    for (int32 i = 0; i < Child.PathPoints.Num() - 1; i++)
+    if (USceneComponent* Root = Barrier->GetRootComponent())
     {
-        int32 StartPoint = Child.PathPoints[i];
-        int32 EndPoint = Child.PathPoints[i + 1];
+        Root->bWantsOnUpdateTransform = true;
+        Root->TransformUpdated.AddUObject(this, &AGeneticPathFinder::OnBarrierTransformUpdated);
+    }
+}
 
-        if (!IsValidLink(StartPoint, EndPoint))
+void AGeneticPathFinder::UnregisterBarriers()
+{
+    for (const TPair<TWeakObjectPtr<AActor>, FBox>& Entry : BarrierBounds)
+    {
+        if (AActor* Barrier = Entry.Key.Get())
         {
-            UE_LOG(LogTemp, Warning, TEXT("Invalid link detected between %d and %d, fixing..."), StartPoint, EndPoint);
-            const TArray<int32>* ValidStartLinks = ValidLinks.Find(StartPoint);
-            if (ValidStartLinks && ValidStartLinks->Num() > 0)
+            Barrier->OnDestroyed.RemoveDynamic(this, &AGeneticPathFinder::OnBarrierDestroyed);
+            if (USceneComponent* Root = Barrier->GetRootComponent())
             {
-                // Replace with a valid link
-                EndPoint = (*ValidStartLinks)[FMath::RandRange(0, ValidStartLinks->Num() - 1)];
-                Child.PathPoints[i + 1] = EndPoint;  // Update the path
+                Root->TransformUpdated.RemoveAll(this);
             }
         }
     }
 
-    // Explicitly set the start and end points for the child path
-    if (Child.PathPoints.Num() > 0)
+    BarrierBounds.Reset();
+    DirtyBarriers.Reset();
+    PendingBarrierRegions.Reset();
+    ResetBarrierCollision();
+}
+
+void AGeneticPathFinder::OnActorRegistered(FName Tag, AActor* Actor)
+{
+    if (Tag == UPathActorRegistry::BarrierTag && !BarrierBounds.Contains(Actor))
     {
-        Child.PathPoints[0] = Parent1.PathPoints[0];  // Ensure the start point is from Parent1
-        Child.PathPoints[Child.PathPoints.Num() - 1] = Parent2.PathPoints.Last();  // Ensure the end point is from Parent2
+        RegisterBarrier(Actor);
+        DirtyBarriers.Add(Actor);
     }
+}
 
-    // Optionally, handle the case where the child path is incomplete or invalid
-    if (Child.PathPoints.Num() == 0)
+void AGeneticPathFinder::OnBarrierDestroyed(AActor* DestroyedActor)
+{
+    // Links the barrier blocked may open up, its collision is gone by the next tick
+    FBox OldBounds;
+    if (BarrierBounds.RemoveAndCopyValue(DestroyedActor, OldBounds))
     {
-        UE_LOG(LogTemp, Warning, TEXT("Child path is empty after crossover!"));
+        PendingBarrierRegions.Add(OldBounds);
     }
-
-    return Child;
+    DirtyBarriers.Remove(DestroyedActor);
 }
 
-
-
-
-
-
-// Mutation function: Randomly change part of the path
-void AGeneticPathFinder::Mutate(FPath& Path)
+void AGeneticPathFinder::OnBarrierTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
 {
-    UE_LOG(LogTemp, Warning, TEXT("Mutation started"));
-    float RandValue = FMath::FRand();
-    UE_LOG(LogTemp, Warning, TEXT("Random Value: %f"), RandValue);
+    // Child components may not have moved yet, bounds are read once per frame in Tick
+    DirtyBarriers.Add(UpdatedComponent->GetOwner());
+}
 
-    if (RandValue < MUTATION_RATE)
+void AGeneticPathFinder::UpdateLinksNearBarriers()
+{
+    // Old and new bounds of every barrier that moved or spawned this frame
+    for (const TWeakObjectPtr<AActor>& Barrier : DirtyBarriers)
     {
-        // Ensure there are points to mutate (avoid the start and end points)
-        if (Path.PathPoints.Num() <= 2)  // At least 2 points (start and end)
+        AActor* Actor = Barrier.Get();
+        FBox* Bounds = BarrierBounds.Find(Barrier);
+        if (Actor && Bounds)
         {
-            UE_LOG(LogTemp, Warning, TEXT("Mutation aborted: Path has too few points."));
-            return;
+            PendingBarrierRegions.Add(*Bounds);
+            *Bounds = Actor->GetComponentsBoundingBox(true);
+            PendingBarrierRegions.Add(*Bounds);
         }
+    }
+    DirtyBarriers.Reset();
 
-        UE_LOG(LogTemp, Warning, TEXT("Mutation started 2.0"));
-
-        // Select a random mutation point (excluding start and end points)
-        int32 MutationPoint = FMath::RandRange(1, Path.PathPoints.Num() - 2);  // Skip start (0) and end (Num()-1)
-        UE_LOG(LogTemp, Warning, TEXT("MutationPoint selected: %d"), MutationPoint);
-
-        int32 MutationIndex = Path.PathPoints[MutationPoint];
-        UE_LOG(LogTemp, Warning, TEXT("MutationIndex selected: %d"), MutationIndex);
-
-        // Ensure valid links exist for the mutation index
-        const TArray<int32>* Links = ValidLinks.Find(MutationIndex);
-        if (Links == nullptr || Links->Num() == 0)
+    // The running solve reads the graph, keep the regions until it is done. With replanning on, a solve
+    // in flight is cancelled, and Tick collects it once it stopped instead of the game thread waiting for
+    // it. The update then runs on the tick that collects it and the replan picks the population up
+    if (PendingBarrierRegions.Num() == 0)
+    {
+        return;
+    }
+    if (SolveHandle.IsValid())
+    {
+        if (bReplanOnLinkChange && !SolveHandle.IsCancelled())
         {
-            UE_LOG(LogTemp, Warning, TEXT("Mutation point %d has no valid links or links array is empty!"), MutationIndex);
-            return;
+            CancelGeneticAlgorithm();
+            bReplanAfterLinkUpdate = true;
         }
+        return;
+    }
 
-        // Find a valid link for mutation
-        bool bValidLinkFound = false;
-        int32 NewPoint = -1;
+    TRACE_CPUPROFILER_EVENT_SCOPE(AGeneticPathFinder::UpdateLinksNearBarriers);
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_UpdateLinks);
 
-        // Try mutating the point to a new valid link
-        for (int32 i = 0; i < Links->Num(); i++)
-        {
-            int32 CandidatePoint = (*Links)[i];
+    // A swept link is affected by barriers up to the widest probed shape away from its segment
+    const float SweepReach = FMath::Max3(AgentRadius, AgentHalfHeight, MaxClearance);
+    TArray<FBox> Regions = MoveTemp(PendingBarrierRegions);
+    PendingBarrierRegions.Reset();
+    for (FBox& Region : Regions)
+    {
+        Region = Region.ExpandBy(SweepReach);
+    }
 
-            // Ensure the mutated point has valid links to both its neighbors
-            int32 PreviousPoint = Path.PathPoints[MutationPoint - 1];
-            int32 NextPoint = Path.PathPoints[MutationPoint + 1];
+    // Both ends of a link that crosses a region lie within the link's length of it. With a cutoff only the
+    // points in grid cells around the regions can start one, without one any pair may cross
+    const int32 NumNodes = LinkGraph.GetNumNodes();
+    const bool bUseLinkCutoff = MaxLinkDistance > 0.0f;
+    const float MaxLinkDistanceSquared = FMath::Square(MaxLinkDistance);
+    if (LinkGridCellSize != MaxLinkDistance)
+    {
+        BuildLinkGrid();
+    }
 
-            if (IsValidLink(PreviousPoint, CandidatePoint) && IsValidLink(CandidatePoint, NextPoint))
+    TArray<int32> Candidates;
+    TBitArray<> IsCandidate(!bUseLinkCutoff, NumNodes);
+    if (bUseLinkCutoff)
+    {
+        for (const FBox& Region : Regions)
+        {
+            const FBox Reach = Region.ExpandBy(MaxLinkDistance);
+            const FIntVector MinCell = GetLinkCell(Reach.Min);
+            const FIntVector MaxCell = GetLinkCell(Reach.Max);
+            auto AddBucket = [&](const TArray<int32>& Bucket)
+                {
+                    for (const int32 Point : Bucket)
+                    {
+                        if (!IsCandidate[Point] && Reach.IsInsideOrOn(LinkGraph.GetNodeLocation(Point)))
+                        {
+                            IsCandidate[Point] = true;
+                            Candidates.Add(Point);
+                        }
+                    }
+                };
+
+            // A region spanning more cells than the grid holds walks the grid's cells instead
+            const int64 NumCells = int64(MaxCell.X - MinCell.X + 1) * (MaxCell.Y - MinCell.Y + 1) * (MaxCell.Z - MinCell.Z + 1);
+            if (NumCells > LinkGrid.Num())
             {
-                NewPoint = CandidatePoint;
-                bValidLinkFound = true;
-                break;
+                for (const TPair<FIntVector, TArray<int32>>& Cell : LinkGrid)
+                {
+                    if (Cell.Key.X >= MinCell.X && Cell.Key.X <= MaxCell.X && Cell.Key.Y >= MinCell.Y && Cell.Key.Y <= MaxCell.Y
+                        && Cell.Key.Z >= MinCell.Z && Cell.Key.Z <= MaxCell.Z)
+                    {
+                        AddBucket(Cell.Value);
+                    }
+                }
+                continue;
+            }
+            for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+            {
+                for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+                {
+                    for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+                    {
+                        if (const TArray<int32>* Bucket = LinkGrid.Find(FIntVector(X, Y, Z)))
+                        {
+                            AddBucket(*Bucket);
+                        }
+                    }
+                }
             }
         }
-
-        if (!bValidLinkFound)
+        Candidates.Sort();
+    }
+    else
+    {
+        Candidates.SetNumUninitialized(NumNodes);
+        for (int32 Point = 0; Point < NumNodes; Point++)
         {
-            UE_LOG(LogTemp, Warning, TEXT("No valid links found for mutation point %d!"), MutationIndex);
-            return;
+            Candidates[Point] = Point;
         }
-
-        // Apply the mutation
-        Path.PathPoints[MutationPoint] = NewPoint;
-        UE_LOG(LogTemp, Warning, TEXT("Mutated Path at Point %d to %d"), MutationPoint, NewPoint);
     }
-}
 
+    // Only pairs whose segment crosses a changed region can have changed, re-trace just those.
+    // A link that stays valid with a new clearance is both removed and added, which replaces it
+    TArray<TArray<FIntPoint>> RowAdded;
+    TArray<TArray<float>> RowAddedClearances;
+    TArray<TArray<FIntPoint>> RowRemoved;
+    TArray<int32> RowRemeasured;
+    RowAdded.SetNum(Candidates.Num());
+    RowAddedClearances.SetNum(Candidates.Num());
+    RowRemoved.SetNum(Candidates.Num());
+    RowRemeasured.SetNumZeroed(Candidates.Num());
+    ParallelFor(Candidates.Num(), [&](int32 Row)
+        {
+            const int32 i = Candidates[Row];
+            const FVector Start = LinkGraph.GetNodeLocation(i);
+            auto RetracePair = [&](int32 j)
+                {
+                    const FVector End = LinkGraph.GetNodeLocation(j);
+                    if (bUseLinkCutoff && FVector::DistSquared(Start, End) > MaxLinkDistanceSquared)
+                    {
+                        return;
+                    }
 
+                    const bool bCrossesRegion = Regions.ContainsByPredicate([&](const FBox& Region)
+                        {
+                            return FMath::LineBoxIntersection(Region, Start, End, End - Start);
+                        });
+                    if (!bCrossesRegion)
+                    {
+                        return;
+                    }
 
-// The main Genetic Algorithm
-void AGeneticPathFinder::StartGeneticAlgorithm()
-{
-    int StagnationCount = 0;  // Counter for generations without improvement
-    const int MaxStagnationCount = 20;  // Number of generations with no improvement to allow before stopping
+                    const bool bWasLinked = LinkGraph.IsValidLink(i, j);
+                    float Clearance = 0.0f;
+                    const bool bIsLinked = TraceLink(i, j, Clearance);
+                    if (bIsLinked && (!bWasLinked || Clearance != LinkGraph.GetLinkClearance(i, j)))
+                    {
+                        RowAdded[Row].Emplace(i, j);
+                        RowAddedClearances[Row].Add(Clearance);
+                    }
+                    if (bWasLinked && (!bIsLinked || Clearance != LinkGraph.GetLinkClearance(i, j)))
+                    {
+                        RowRemoved[Row].Emplace(i, j);
+                    }
+                    if (bIsLinked && bWasLinked && Clearance != LinkGraph.GetLinkClearance(i, j))
+                    {
+                        RowRemeasured[Row]++;
+                    }
+                };
+
+            if (!bUseLinkCutoff)
+            {
+                for (int32 j = i + 1; j < NumNodes; j++)
+                {
+                    RetracePair(j);
+                }
+                return;
+            }
+
+            // Partners come from the neighboring cells, and have to be candidates themselves
+            const FIntVector Cell = GetLinkCell(Start);
+            for (int32 DZ = -1; DZ <= 1; DZ++)
+            {
+                for (int32 DY = -1; DY <= 1; DY++)
+                {
+                    for (int32 DX = -1; DX <= 1; DX++)
+                    {
+                        if (const TArray<int32>* Bucket = LinkGrid.Find(Cell + FIntVector(DX, DY, DZ)))
+                        {
+                            for (const int32 j : *Bucket)
+                            {
+                                if (j > i && IsCandidate[j])
+                                {
+                                    RetracePair(j);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }, EParallelForFlags::Unbalanced);
 
-    // Initialize population with random paths
-    for (int i = 0; i < POPULATION_SIZE; i++)
+    TArray<FIntPoint> Added;
+    TArray<float> AddedClearances;
+    TArray<FIntPoint> Removed;
+    int32 NumRemeasured = 0;
+    for (int32 Row = 0; Row < Candidates.Num(); Row++)
     {
-        FPath newPath = GenerateRandomPath();
-        UE_LOG(LogTemp, Warning, TEXT("new generated path:"));
-        LogPath(newPath);
-        Population.Add(newPath);
+        Added.Append(RowAdded[Row]);
+        AddedClearances.Append(RowAddedClearances[Row]);
+        Removed.Append(RowRemoved[Row]);
+        NumRemeasured += RowRemeasured[Row];
     }
 
-    // Evolve population over generations
-    for (int Gen = 0; Gen < MAX_GENERATIONS; Gen++)
+    // A solve cancelled for this update is relaunched even when no link changed
+    const bool bRelaunch = bReplanAfterLinkUpdate;
+    bReplanAfterLinkUpdate = false;
+    if (Added.Num() > 0 || Removed.Num() > 0)
     {
-        // Calculate fitness for each individual
-        for (FPath& Path : Population)
-        {
-            Path.Fitness = CalculateFitness(Path);
-            UE_LOG(LogTemp, Warning, TEXT("CalculateFitness called"));
-        }
-
-        // Sort the population by fitness (best first)
-        Population.Sort([](const FPath& A, const FPath& B) { return A.Fitness > B.Fitness; });
-
-        // Track fitness changes
-        static float PreviousBestFitness = 0.0f;
-        float CurrentBestFitness = Population[0].Fitness;
-
-        if (CurrentBestFitness == PreviousBestFitness)
-        {
-            StagnationCount++;  // Increment stagnation count if the fitness hasn't improved
-        }
-        else
-        {
-            StagnationCount = 0;  // Reset stagnation count if there's an improvement
-        }
-
-        // If the best fitness hasn't improved for a set number of generations, stop
-        if (StagnationCount >= MaxStagnationCount)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Stopping due to stagnation (no improvement in best fitness for %d generations)."), MaxStagnationCount);
-            LogPath(Population[0]);
-            VisualizePath(Population[0]);
-            break;
-        }
-
-        // Store the best fitness for the next generation check
-        PreviousBestFitness = CurrentBestFitness;
-
-        // Generate next generation
-        TArray<FPath> NewGeneration;
-        UE_LOG(LogTemp, Warning, TEXT("NewGeneration created"));
-        UE_LOG(LogTemp, Warning, TEXT("population[0]:"));
-        LogPath(Population[0]);
-        UE_LOG(LogTemp, Warning, TEXT("population[1]:"));
-        LogPath(Population[1]);
-
-        // Elitism: Keep the top 2 paths
-        NewGeneration.Add(Population[0]);
-        UE_LOG(LogTemp, Warning, TEXT("NewGeneration.Add(Population[0]);"));
-        NewGeneration.Add(Population[1]);
-        UE_LOG(LogTemp, Warning, TEXT("NewGeneration.Add(Population[1]);"));
-
-        // Create new paths by crossover and mutation
-        while (NewGeneration.Num() < POPULATION_SIZE)
-        {
-            FPath Parent1, Parent2;
-            UE_LOG(LogTemp, Warning, TEXT("Before SelectParents"));
-            SelectParents(Parent1, Parent2);
-            UE_LOG(LogTemp, Warning, TEXT("Before crossover"));
-            FPath Child = Crossover(Parent1, Parent2);
-            UE_LOG(LogTemp, Warning, TEXT("Child after crossover:"));
-            LogPath(Child);
-            UE_LOG(LogTemp, Warning, TEXT("Before child mutated:"));
-            Mutate(Child);
-            UE_LOG(LogTemp, Warning, TEXT("Child after mutation:"));
-            LogPath(Child);
-
-            NewGeneration.Add(Child);
-            UE_LOG(LogTemp, Warning, TEXT("NewGeneration.Add(Child);"));
-        }
+        LinkGraph.UpdateLinks(Added, Removed, TConstArrayView<float>(), AddedClearances);
+        PublishLinkGraph();
+        UE_LOG(LogGeneticPath, Log, TEXT("Barrier change: %d links added, %d removed, %d re-measured, graph version %u."),
+            Added.Num() - NumRemeasured, Removed.Num() - NumRemeasured, NumRemeasured, LinkGraph.GetVersion());
+        OnLinkGraphChanged.Broadcast(LinkGraph.GetVersion());
+    }
+    else if (!bRelaunch)
+    {
+        return;
+    }
 
-        // Replace the old population with the new one
-        UE_LOG(LogTemp, Warning, TEXT("before new gen"));
-        Population = NewGeneration;
-        UE_LOG(LogTemp, Warning, TEXT("after new gen"));
-        UE_LOG(LogTemp, Warning, TEXT("Generation %d: Best Fitness = %f"), Gen, Population[0].Fitness);
+    if (bReplanOnLinkChange)
+    {
+        ReplanAsync();
     }
 }
 
-void AGeneticPathFinder::VisualizePath(const FPath& Path)
+void AGeneticPathFinder::PublishLinkGraph() const
 {
-    if (Path.PathPoints.Num() < 2)
+    if (UGeneticPathSubsystem* PathSubsystem = GetWorld()->GetSubsystem<UGeneticPathSubsystem>())
     {
-        return; // No valid path to visualize
+        PathSubsystem->SetLinkGraph(LinkGraph);
     }
+}
 
-    // Iterate through the path points and draw debug lines
-    for (int32 i = 0; i < Path.PathPoints.Num() - 1; i++)
+bool AGeneticPathFinder::TraceLink(int32 StartPoint, int32 EndPoint, float& OutClearance) const
+{
+    OutClearance = 0.0f;
+    if (!SweepLink(StartPoint, EndPoint, AgentRadius))
     {
-        // Get the actor from PointNodes using Path.PathPoints[i], which is an index
-        TObjectPtr<AActor> ActorStartPtr = PointNodes[Path.PathPoints[i]];
-        TObjectPtr<AActor> ActorEndPtr = PointNodes[Path.PathPoints[i + 1]];
+        return false;
+    }
 
-        // Check if the actors are valid by checking if the pointers are non-null
-        if (ActorStartPtr && ActorEndPtr)
+    // Every radius up to Low is known to fit, binary search towards the widest one that still does
+    float Low = AgentRadius;
+    float High = MaxClearance;
+    if (High > Low && SweepLink(StartPoint, EndPoint, High))
+    {
+        Low = High;
+    }
+    for (int32 Step = 0; Step < ClearanceSearchSteps && High > Low; Step++)
+    {
+        const float Radius = 0.5f * (Low + High);
+        if (SweepLink(StartPoint, EndPoint, Radius))
         {
-            // Dereference the TObjectPtr to get the raw AActor pointer
-            AActor* ActorStart = ActorStartPtr.Get();
-            AActor* ActorEnd = ActorEndPtr.Get();
-
-            if (ActorStart && ActorEnd)
-            {
-                FVector Start = ActorStart->GetActorLocation();
-                FVector End = ActorEnd->GetActorLocation();
-
-                // Draw a line between the points
-                DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 10.0f, 0, 1);
-            }
+            Low = Radius;
         }
         else
         {
-            UE_LOG(LogTemp, Warning, TEXT("Invalid actor at path points %d and %d"), i, i + 1);
+            High = Radius;
         }
     }
+
+    OutClearance = Low;
+    return true;
 }
-void AGeneticPathFinder::LogPath(const FPath& Path)
+
+bool AGeneticPathFinder::SweepLink(int32 StartPoint, int32 EndPoint, float Radius) const
 {
-    FString PathString = TEXT("");
+    // Ignore only the two point nodes themselves so they can't block their own link
+    FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(DefineLinks), false, PointNodes[StartPoint]);
+    CollisionParams.AddIgnoredActor(PointNodes[EndPoint]);
 
-    // Iterate through the points in the path and log them
-    for (int32 i = 0; i < Path.PathPoints.Num(); i++)
-    {
-        PathString += FString::Printf(TEXT("%d"), Path.PathPoints[i]);
+    const FVector Start = LinkGraph.GetNodeLocation(StartPoint);
+    const FVector End = LinkGraph.GetNodeLocation(EndPoint);
+    const FCollisionShape Shape = AgentHalfHeight > Radius ? FCollisionShape::MakeCapsule(Radius, AgentHalfHeight) : FCollisionShape::MakeSphere(Radius);
 
-        if (i < Path.PathPoints.Num() - 1)
+    // With every barrier on the Barrier profile only barrier geometry is tested, and a test query
+    // stops at the first blocking hit without filling a result
+    if (FallbackBarrierComponents.Num() == 0)
+    {
+        if (Radius <= 0.0f)
         {
-            PathString += TEXT(" -> ");
+            return !GetWorld()->LineTraceTestByObjectType(Start, End, BarrierObjectParams, CollisionParams);
         }
+        return !GetWorld()->SweepTestByObjectType(Start, End, FQuat::Identity, BarrierObjectParams, Shape, CollisionParams);
+    }
+
+    // Otherwise the query also sees whatever else shares those channels, an object query returns every
+    // hit along the way and only the ones on barrier components block the link
+    TArray<FHitResult> Hits;
+    if (Radius <= 0.0f)
+    {
+        GetWorld()->LineTraceMultiByObjectType(Hits, Start, End, BarrierObjectParams, CollisionParams);
+    }
+    else
+    {
+        GetWorld()->SweepMultiByObjectType(Hits, Start, End, FQuat::Identity, BarrierObjectParams, Shape, CollisionParams);
     }
+    return !Hits.ContainsByPredicate([this](const FHitResult& Hit)
+        {
+            const UPrimitiveComponent* Component = Hit.GetComponent();
+            return Component && (Component->GetCollisionObjectType() == ECC_Barrier || FallbackBarrierComponents.Contains(Component));
+        });
+}
 
-    // Log the path to the output
-    UE_LOG(LogTemp, Warning, TEXT("%s"), *PathString);
+void AGeneticPathFinder::ResetBarrierCollision()
+{
+    BarrierObjectParams = FCollisionObjectQueryParams(ECC_Barrier);
+    FallbackBarrierComponents.Reset();
 }
-bool AGeneticPathFinder::IsValidLink(int32 StartPoint, int32 EndPoint)
+
+void AGeneticPathFinder::AddBarrierCollision(AActor* Barrier)
 {
-    // Check if there is a valid link between the points
-    const TArray<int32>* ValidLinksForStart = ValidLinks.Find(StartPoint);
-    if (ValidLinksForStart && ValidLinksForStart->Contains(EndPoint))
+    // Barrier_BP uses the Barrier profile. A barrier placed with another profile still blocks links
+    // through its own channel, its collision belongs to the level and is left as it is. As before,
+    // the components that stop a visibility trace are the ones that block links
+    bool bOffProfile = false;
+    TInlineComponentArray<UPrimitiveComponent*> Primitives(Barrier);
+    for (UPrimitiveComponent* Primitive : Primitives)
     {
-        return true;  // Link is valid
+        const ECollisionChannel ObjectType = Primitive->GetCollisionObjectType();
+        if (Primitive->IsQueryCollisionEnabled() && Primitive->GetCollisionResponseToChannel(ECC_Visibility) == ECR_Block
+            && ObjectType != ECC_Barrier)
+        {
+            BarrierObjectParams.AddObjectTypesToQuery(ObjectType);
+            FallbackBarrierComponents.Add(Primitive);
+            bOffProfile = true;
+        }
     }
 
-    return false;  // Link is invalid
+    if (bOffProfile)
+    {
+        UE_LOG(LogGeneticPath, Warning, TEXT("Barrier %s is not on the Barrier collision profile, its links are traced the slow way."), *Barrier->GetName());
+    }
 }
@@ -4,14 +4,30 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "CollisionQueryParams.h"
+#include "UObject/ObjectKey.h"
+#include "GeneticSolver.h"
+#include "PathGraph.h"
+#include "PathSolver.h"
 #include "GeneticPathFinder.generated.h"
 
+class ULineBatchComponent;
+
+// Fired on the game thread when a background solve finishes with its best path
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnGeneticPathSolved, const FPath& /*BestPath*/);
+
+// Fired on the game thread after links were added or removed, with the new graph version
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnLinkGraphChanged, uint32 /*GraphVersion*/);
+
+// Level-facing adapter: gathers the tagged point and barrier actors into a FPathGraph
+// and runs a path solver (the GA by default) on it in the background
 UCLASS()
 class MYPROJECT2_API AGeneticPathFinder : public AActor
 {
 	GENERATED_BODY()
-	
-public:	
+
+public:
 	// Sets default values for this actor's properties
 	AGeneticPathFinder();
 
@@ -19,49 +35,255 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	
+    // Cancels and waits for any solve still in flight
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
     virtual void Tick(float DeltaTime) override;
 
     // Function to define valid links between points
     void DefineLinks();
 
-    // Function to start the genetic algorithm
-    void StartGeneticAlgorithm();
+    // Points further apart than this are never linked or traced, 0 traces every pair
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    float MaxLinkDistance = 0.0f;
+
+    // Radius of the agents walking the links, links are swept with this shape instead of a line. 0 traces a line
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Agent", meta = (ClampMin = "0", Units = "cm"))
+    float AgentRadius = 0.0f;
+
+    // Half height of the agents, a capsule is swept when it is above AgentRadius and a sphere otherwise
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Agent", meta = (ClampMin = "0", Units = "cm"))
+    float AgentHalfHeight = 0.0f;
+
+    // Widest radius a link's clearance is measured up to, stored per link in the graph. At or below
+    // AgentRadius nothing is measured and every link stores AgentRadius
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Agent", meta = (ClampMin = "0", Units = "cm"))
+    float MaxClearance = 0.0f;
+
+    // Extra sweeps per valid link that narrow the measured clearance down, each halves the error
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Agent", meta = (ClampMin = "0", ClampMax = "16"))
+    int32 ClearanceSearchSteps = 4;
+
+    // Function to launch the genetic algorithm on a background task
+    void StartGeneticAlgorithmAsync();
+
+    // Function to solve again from the last solve's population after the links or the start changed,
+    // only the paths the change broke are repaired. A new start actor replaces the current one
+    void ReplanAsync(AActor* NewStartActor = nullptr);
+
+    // Function to cancel the running background solve, if any
+    void CancelGeneticAlgorithm();
+
+    bool IsSolveInProgress() const { return SolveHandle.IsValid(); }
+
+    // Search strategy for this actor's solve, Auto picks an exact search on small graphs
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    EPathSolverType SolverType = EPathSolverType::Genetic;
+
+    // Seed for the solver's random streams, 0 picks a new seed for every solve
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    int32 RandomSeed = 0;
+
+    // Paths per population, ignored when the module is built with GENETIC_PATH_FIXED_POPULATION_SIZE
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Genetic", meta = (ClampMin = "2"))
+    int32 PopulationSize = 20;
+
+    // Chance that a child gets one point mutated
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Genetic", meta = (ClampMin = "0", ClampMax = "1"))
+    float MutationRate = 0.05f;
+
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Genetic", meta = (ClampMin = "1"))
+    int32 MaxGenerations = 1000;
+
+    // How parents are picked, tournament and rank favor fitter paths
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Genetic")
+    EGeneticSelectionType Selection = EGeneticSelectionType::Tournament;
+
+    // Paths competing in each tournament, higher means stronger selection pressure
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Genetic", meta = (ClampMin = "1", EditCondition = "Selection == EGeneticSelectionType::Tournament"))
+    int32 TournamentSize = 3;
+
+    // Points a population slot holds, longer paths are cut. Bounds the population's memory on big graphs, 0 for no cap
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Genetic", meta = (ClampMin = "0"))
+    int32 MaxPathLength = 1024;
+
+    // Number of independent populations evolved in parallel, 1 runs a single population
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Islands", meta = (ClampMin = "1"))
+    int32 IslandCount = 1;
+
+    // Generations between migrations when IslandCount > 1
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Islands", meta = (ClampMin = "1"))
+    int32 MigrationInterval = 10;
+
+    // Best paths each island sends to its neighbor on every migration
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Islands", meta = (ClampMin = "0"))
+    int32 MigrantCount = 2;
+
+    // Link checks per generation spent refining offspring by shortcut removal and 2-opt, 0 turns it off
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Local Search", meta = (ClampMin = "0"))
+    int32 LocalSearchBudget = 0;
+
+    // Wall-clock budget of a genetic solve in seconds, the best path so far is used when it runs out. 0 for none
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Stopping", meta = (ClampMin = "0", Units = "s"))
+    float TimeLimitSeconds = 0.0f;
+
+    // Stop as soon as a path reaches this fitness, 0 for none
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Stopping", meta = (ClampMin = "0"))
+    float TargetFitness = 0.0f;
+
+    // Generations the best fitness may stay within ConvergenceTolerance before the solve counts as converged
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Stopping", meta = (ClampMin = "1"))
+    int32 ConvergenceWindow = 20;
+
+    // Relative fitness change below which the best and mean fitness count as settled
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Stopping", meta = (ClampMin = "0"))
+    float ConvergenceTolerance = 0.001f;
+
+    // Fitness spread (standard deviation over mean) below which the population counts as collapsed
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Stopping", meta = (ClampMin = "0"))
+    float MinDiversity = 0.01f;
+
+    // Replan as soon as barrier changes re-traced some links, a solve still running is cancelled for it
+    UPROPERTY(EditAnywhere, Category = "Pathfinding")
+    bool bReplanOnLinkChange = false;
+
+    // Load the link graph from the level's bake when its layout hash still matches, instead of tracing.
+    // In the editor a missing or stale bake is written again after tracing
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Bake")
+    bool bUseBakedLinkGraph = true;
+
+    // Draw every link of the graph, redrawn only when the links change
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Debug")
+    bool bDrawLinkGraph = false;
 
-    // Function to calculate the fitness of a path
-    float CalculateFitness(const struct FPath& Path);
+    // Draw the best path, including the improvements of a running solve
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Debug")
+    bool bDrawBestPath = true;
 
-    // Function to generate a random path
-    struct FPath GenerateRandomPath();
+    // Draw how many paths of the running GA population cross each link, from blue to red
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Debug")
+    bool bDrawEdgeUsage = false;
 
-    // Function to select two parents for crossover
-    void SelectParents(struct FPath& Parent1, struct FPath& Parent2);
+    // Seconds between two samples of the population's link usage
+    UPROPERTY(EditAnywhere, Category = "Pathfinding|Debug", meta = (ClampMin = "0", Units = "s", EditCondition = "bDrawEdgeUsage"))
+    float EdgeUsageInterval = 0.1f;
+
+#if WITH_EDITOR
+    // Trace the links in the editor world and write them to the level's bake
+    UFUNCTION(CallInEditor, Category = "Pathfinding|Bake")
+    void BakeLinkGraph();
+#endif
 
-    // Function to crossover two paths
-    struct FPath Crossover(const struct FPath& Parent1, const struct FPath& Parent2);
     void VisualizePath(const FPath& Path);
-    // Function to mutate a path
-    void Mutate(struct FPath& Path);
-    void LogPath(const FPath& Path);
-    bool IsValidLink(int32 StartPoint, int32 EndPoint);
-    
+
+    const FPathGraph& GetLinkGraph() const { return LinkGraph; }
+
+    // Broadcast on the game thread with the best path once a solve completes
+    FOnGeneticPathSolved OnPathSolved;
+
+    // Broadcast on the game thread while a solve runs, whenever it found a better path.
+    // Agents can start moving on it and switch once OnPathSolved arrives
+    FOnGeneticPathSolved OnPathImproved;
+
+    // Broadcast when barrier changes re-traced some links
+    FOnLinkGraphChanged OnLinkGraphChanged;
+
+    // Best path from the last completed solve
+    FPath BestPath;
+
 private:
-    // Store the list of point nodes and valid links
+    // Function to collect the point actors into PointNodes and the graph, sorted by name so
+    // indices match a bake. Returns the barrier actors
+    TArray<AActor*> GatherLinkActors();
+
+    // Function to hash everything the traced links depend on: point and barrier placement, the cutoff and the agent shape
+    uint64 ComputeLayoutHash(TConstArrayView<AActor*> Barriers) const;
+
+    // Function to trace every candidate pair and rebuild the graph's links
+    void TraceAllLinks();
+
+    // Function to bucket the graph's points into cells of MaxLinkDistance, and the cell of a location
+    void BuildLinkGrid();
+    FIntVector GetLinkCell(const FVector& Location) const;
+
+    // Function to sweep one candidate link against the barrier channel and measure its clearance,
+    // safe to call from worker threads
+    bool TraceLink(int32 StartPoint, int32 EndPoint, float& OutClearance) const;
+
+    // Function to sweep a link with the agent shape grown to Radius, true if no barrier is in the way
+    bool SweepLink(int32 StartPoint, int32 EndPoint, float Radius) const;
+
+    // Functions to collect the object channels the link traces query, the barrier channel plus the
+    // channel of any barrier component that isn't on it. Barrier collision itself is never changed
+    void ResetBarrierCollision();
+    void AddBarrierCollision(AActor* Barrier);
+
+    // Functions to track barrier actors so only links near a changed barrier get re-traced
+    void RegisterBarrier(AActor* Barrier);
+    void UnregisterBarriers();
+    void OnActorRegistered(FName Tag, AActor* Actor);
+    void OnBarrierTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+    UFUNCTION()
+    void OnBarrierDestroyed(AActor* DestroyedActor);
+
+    // Function to start a background solve, warm started from the last population for a replan
+    void LaunchSolve(bool bWarmStart);
+
+    // Function to re-trace the pairs crossing old or new barrier bounds, bumps the graph version
+    void UpdateLinksNearBarriers();
+
+    // Function to hand the current graph to the path query subsystem, so agents share it
+    void PublishLinkGraph() const;
+
+    // Function to bring the debug layers up to date with the graph and the running solve
+    void UpdateDebugDraw();
+
+    // All debug lines of this actor in one persistent batch, created on BeginPlay
+    UPROPERTY(Transient)
+    TObjectPtr<ULineBatchComponent> DebugLines;
+
+    // Graph version the graph layer was drawn for
+    uint32 DrawnGraphVersion = 0;
+    TArray<int32> EdgeUsage;
+
+    // Store the list of point nodes, their indices match the graph's
     TArray<AActor*> PointNodes;
-    TMap<int32, TArray<int32>> ValidLinks;
 
-    // Population for the genetic algorithm
-    TArray<struct FPath> Population;
+    // Point positions and valid links, the solver never reads actors
+    FPathGraph LinkGraph;
+
+    // Created on the first solve and whenever the strategy changes, the GA keeps its population between solves
+    TUniquePtr<IPathSolver> Solver;
+
     AActor* StartActor;
     AActor* EndActor;
-    
-};
-struct FPath
-{
-    TArray<int32> PathPoints; // List of point indices representing the path
-    float Fitness;             // Fitness of the path
+    int32 StartIndex = INDEX_NONE;
+    int32 EndIndex = INDEX_NONE;
 
-    FPath() : Fitness(0.0f) {} // Default constructor
-    
-};
\ No newline at end of file
+    FGeneticSolveHandle SolveHandle;
+
+    // Known barriers by their bounds at the last link update
+    TMap<TWeakObjectPtr<AActor>, FBox> BarrierBounds;
+
+    // Object channels of all barriers, and the barrier components outside the Barrier profile whose
+    // channels may hold other geometry too, so only hits on them count
+    FCollisionObjectQueryParams BarrierObjectParams;
+    TSet<TObjectKey<UPrimitiveComponent>> FallbackBarrierComponents;
+
+    // Barriers that moved or spawned since the last tick, and regions still waiting for a re-trace
+    TSet<TWeakObjectPtr<AActor>> DirtyBarriers;
+    TArray<FBox> PendingBarrierRegions;
+
+    // Set when a solve was cancelled for pending barrier regions, it is relaunched after the update
+    bool bReplanAfterLinkUpdate = false;
+
+    // Points by grid cell, so a link can only join points of neighboring cells. Empty without a cutoff
+    TMap<FIntVector, TArray<int32>> LinkGrid;
+    float LinkGridCellSize = 0.0f;
+
+    FDelegateHandle ActorRegisteredHandle;
+
+};
@@ -0,0 +1,386 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GeneticPathSubsystem.h"
+#include "MyProject2.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Algo/Reverse.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+static TAutoConsoleVariable<float> CVarGeneticPathFrameBudgetMs(
+    TEXT("GeneticPath.FrameBudgetMs"),
+    2.0f,
+    TEXT("Estimated solver milliseconds the path query subsystem may start per frame. At least one query starts per frame."));
+
+static TAutoConsoleVariable<int32> CVarGeneticPathMaxRunningQueries(
+    TEXT("GeneticPath.MaxRunningQueries"),
+    4,
+    TEXT("Path queries solved in the background at the same time."));
+
+static TAutoConsoleVariable<int32> CVarGeneticPathResultCacheSize(
+    TEXT("GeneticPath.ResultCacheSize"),
+    256,
+    TEXT("Solved paths the path query subsystem keeps for repeated queries, read when the world starts."));
+
+namespace
+{
+    // Function to fold one waiter's urgency into its query
+    void AddWaiter(FGeneticPathQuery& Query, FGeneticPathWaiter&& Waiter, float Priority)
+    {
+        if (Query.Waiters.Num() == 0 || Priority > Query.Priority)
+        {
+            Query.Priority = Priority;
+        }
+        if (Waiter.Deadline > 0.0 && (Query.Deadline <= 0.0 || Waiter.Deadline < Query.Deadline))
+        {
+            Query.Deadline = Waiter.Deadline;
+        }
+        Query.Waiters.Add(MoveTemp(Waiter));
+    }
+
+    // Function to move out the waiters whose deadline passed, returns true if nobody is left waiting
+    bool ExpireWaiters(FGeneticPathQuery& Query, double Now, TArray<FGeneticPathWaiter>& OutExpired)
+    {
+        for (int32 i = 0; i < Query.Waiters.Num(); i++)
+        {
+            FGeneticPathWaiter& Waiter = Query.Waiters[i];
+            if (Waiter.Deadline > 0.0 && Waiter.Deadline < Now)
+            {
+                UE_LOG(LogGeneticPath, Verbose, TEXT("Path request %u (%d -> %d) missed its deadline."), Waiter.RequestId, Query.StartIndex, Query.EndIndex);
+                OutExpired.Add(MoveTemp(Waiter));
+                Query.Waiters.RemoveAt(i--);
+            }
+        }
+        return Query.Waiters.Num() == 0;
+    }
+}
+
+bool UGeneticPathSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGeneticPathSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    ResultCache.Empty(FMath::Max(1, CVarGeneticPathResultCacheSize.GetValueOnGameThread()));
+}
+
+void UGeneticPathSubsystem::Deinitialize()
+{
+    // The solvers and graph snapshots must outlive their tasks
+    for (TUniquePtr<FRunningQuery>& Running : RunningQueries)
+    {
+        Running->Handle.Cancel();
+    }
+    for (TUniquePtr<FRunningQuery>& Running : RunningQueries)
+    {
+        Running->Handle.Task.Wait();
+    }
+    RunningQueries.Reset();
+    PendingQueries.Reset();
+
+    Super::Deinitialize();
+}
+
+TStatId UGeneticPathSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UGeneticPathSubsystem, STATGROUP_Tickables);
+}
+
+void UGeneticPathSubsystem::SetLinkGraph(const FPathGraph& InGraph)
+{
+    // Two finders, or one that gathered its points again, can publish different graphs with the same
+    // version, so every published graph gets its own snapshot id and the old entries are freed
+    static std::atomic<uint32> NextGraphSnapshot = 1;
+    LinkGraphSnapshot = NextGraphSnapshot.fetch_add(1, std::memory_order_relaxed);
+    ResultCache.Empty(ResultCache.Max());
+
+    LinkGraph = MakeShared<const FPathGraph, ESPMode::ThreadSafe>(InGraph);
+
+    // Built by the first hierarchical query on this snapshot and shared by the rest
+    LinkHierarchy = MakeShared<FHierarchicalPathGraphCache, ESPMode::ThreadSafe>();
+}
+
+uint32 UGeneticPathSubsystem::GetSettingsHash(EPathSolverType SolverType) const
+{
+    const uint32 TypeHash = GetTypeHash(SolverType);
+    const bool bRunsGenetic = SolverType == EPathSolverType::Genetic || SolverType == EPathSolverType::Hierarchical;
+    return bRunsGenetic ? HashCombine(TypeHash, GetTypeHash(SolverSettings)) : TypeHash;
+}
+
+bool UGeneticPathSubsystem::FindCachedPath(int32 StartIndex, int32 EndIndex, EPathSolverType SolverType, FPath& OutPath)
+{
+    const FPath* CachedPath = ResultCache.FindAndTouch(FGeneticPathCacheKey(StartIndex, EndIndex, LinkGraphSnapshot, GetSettingsHash(SolverType)));
+    if (!CachedPath)
+    {
+        return false;
+    }
+
+    // Entries run from the lower point to the higher one
+    OutPath = *CachedPath;
+    if (OutPath.PathPoints[0] != StartIndex)
+    {
+        Algo::Reverse(OutPath.PathPoints);
+    }
+    return true;
+}
+
+uint32 UGeneticPathSubsystem::RequestPath(int32 StartIndex, int32 EndIndex, float Priority, double Deadline, FOnPathQueryComplete OnComplete, EPathSolverType SolverType)
+{
+    if (!LinkGraph.IsValid() || !LinkGraph->IsValidNode(StartIndex) || !LinkGraph->IsValidNode(EndIndex))
+    {
+        UE_LOG(LogGeneticPath, Warning, TEXT("Path request %d -> %d rejected, the points are not in the link graph."), StartIndex, EndIndex);
+        return 0;
+    }
+
+    // Auto is resolved here so it dedupes and caches with the strategy it will actually run
+    SolverType = ResolvePathSolverType(SolverType, *LinkGraph);
+
+    FGeneticPathWaiter Waiter;
+    Waiter.RequestId = NextRequestId++;
+
+    FPath CachedPath;
+    if (FindCachedPath(StartIndex, EndIndex, SolverType, CachedPath))
+    {
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Path request %u (%d -> %d) answered from the cache."), Waiter.RequestId, StartIndex, EndIndex);
+        OnComplete.ExecuteIfBound(Waiter.RequestId, CachedPath);
+        return Waiter.RequestId;
+    }
+
+    Waiter.Deadline = Deadline;
+    Waiter.OnComplete = MoveTemp(OnComplete);
+    const uint32 RequestId = Waiter.RequestId;
+
+    auto IsSameQuery = [StartIndex, EndIndex, SolverType](const FGeneticPathQuery& Query)
+        {
+            return Query.StartIndex == StartIndex && Query.EndIndex == EndIndex && Query.SolverType == SolverType;
+        };
+
+    // A query already running on the current graph answers this request too
+    for (TUniquePtr<FRunningQuery>& Running : RunningQueries)
+    {
+        if (Running->Graph == LinkGraph && !Running->Handle.IsCompleted() && !Running->Handle.IsCancelled() && IsSameQuery(Running->Query))
+        {
+            AddWaiter(Running->Query, MoveTemp(Waiter), Priority);
+            return RequestId;
+        }
+    }
+
+    // Identical pending requests share one query
+    FGeneticPathQuery* Query = PendingQueries.FindByPredicate(IsSameQuery);
+    if (!Query)
+    {
+        Query = &PendingQueries.AddDefaulted_GetRef();
+        Query->StartIndex = StartIndex;
+        Query->EndIndex = EndIndex;
+        Query->SolverType = SolverType;
+    }
+    AddWaiter(*Query, MoveTemp(Waiter), Priority);
+    return RequestId;
+}
+
+uint32 UGeneticPathSubsystem::RequestPath(const FVector& Start, const FVector& End, float Priority, double Deadline, FOnPathQueryComplete OnComplete, EPathSolverType SolverType)
+{
+    const int32 StartIndex = LinkGraph.IsValid() ? LinkGraph->FindNearestNode(Start) : INDEX_NONE;
+    const int32 EndIndex = LinkGraph.IsValid() ? LinkGraph->FindNearestNode(End) : INDEX_NONE;
+    return RequestPath(StartIndex, EndIndex, Priority, Deadline, MoveTemp(OnComplete), SolverType);
+}
+
+void UGeneticPathSubsystem::CancelRequest(uint32 RequestId)
+{
+    auto RemoveWaiter = [RequestId](FGeneticPathQuery& Query)
+        {
+            return Query.Waiters.RemoveAll([RequestId](const FGeneticPathWaiter& Waiter) { return Waiter.RequestId == RequestId; }) > 0;
+        };
+
+    for (int32 i = 0; i < PendingQueries.Num(); i++)
+    {
+        if (RemoveWaiter(PendingQueries[i]))
+        {
+            if (PendingQueries[i].Waiters.Num() == 0)
+            {
+                PendingQueries.RemoveAt(i);
+            }
+            return;
+        }
+    }
+
+    for (TUniquePtr<FRunningQuery>& Running : RunningQueries)
+    {
+        if (RemoveWaiter(Running->Query))
+        {
+            // Nobody wants the answer any more, the task is collected once it stops
+            if (Running->Query.Waiters.Num() == 0)
+            {
+                Running->Handle.Cancel();
+            }
+            return;
+        }
+    }
+}
+
+void UGeneticPathSubsystem::Tick(float DeltaTime)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(UGeneticPathSubsystem::Tick);
+
+    CollectFinishedQueries();
+    DropExpiredWaiters(GetWorld()->GetTimeSeconds());
+    StartQueries();
+}
+
+void UGeneticPathSubsystem::CollectFinishedQueries()
+{
+    for (int32 i = 0; i < RunningQueries.Num(); i++)
+    {
+        FRunningQuery& Running = *RunningQueries[i];
+        if (!Running.Handle.IsCompleted())
+        {
+            continue;
+        }
+
+        const bool bCancelled = Running.Handle.IsCancelled();
+        if (!bCancelled)
+        {
+            // Smoothed so one slow or fast solve doesn't swing the budget
+            const double SolveMs = Running.Solver->GetLastSolveSeconds() * 1000.0;
+            EstimatedSolveMs = FMath::Lerp(EstimatedSolveMs, SolveMs, 0.2);
+
+            // Only complete paths on the current graph are worth keeping, a partial one can't be reversed
+            const FPath& Path = Running.Handle.Task.GetResult();
+            const bool bReachedEnd = Path.PathPoints.Num() > 0 && Path.PathPoints[0] == Running.Query.StartIndex && Path.PathPoints.Last() == Running.Query.EndIndex;
+            if (bReachedEnd && Running.bCacheResult && Running.Graph == LinkGraph)
+            {
+                FPath StoredPath = Path;
+                if (Running.Query.StartIndex > Running.Query.EndIndex)
+                {
+                    Algo::Reverse(StoredPath.PathPoints);
+                }
+                ResultCache.Add(FGeneticPathCacheKey(Running.Query.StartIndex, Running.Query.EndIndex, LinkGraphSnapshot, Running.SettingsHash), MoveTemp(StoredPath));
+            }
+        }
+
+        CompleteQuery(Running.Query, bCancelled ? FPath() : Running.Handle.Task.GetResult());
+        RunningQueries.RemoveAt(i--);
+    }
+}
+
+void UGeneticPathSubsystem::DropExpiredWaiters(double Now)
+{
+    TArray<FGeneticPathWaiter> Expired;
+    for (int32 i = PendingQueries.Num() - 1; i >= 0; i--)
+    {
+        if (ExpireWaiters(PendingQueries[i], Now, Expired))
+        {
+            PendingQueries.RemoveAt(i);
+        }
+    }
+
+    for (TUniquePtr<FRunningQuery>& Running : RunningQueries)
+    {
+        if (Running->Query.Waiters.Num() > 0 && ExpireWaiters(Running->Query, Now, Expired))
+        {
+            Running->Handle.Cancel();
+        }
+    }
+
+    // Answered last, callbacks may queue new requests
+    for (FGeneticPathWaiter& Waiter : Expired)
+    {
+        Waiter.OnComplete.ExecuteIfBound(Waiter.RequestId, FPath());
+    }
+}
+
+void UGeneticPathSubsystem::StartQueries()
+{
+    if (PendingQueries.Num() == 0 || !LinkGraph.IsValid())
+    {
+        return;
+    }
+
+    // Most urgent first: highest priority, then the earliest deadline, queries without one last
+    PendingQueries.StableSort([](const FGeneticPathQuery& A, const FGeneticPathQuery& B)
+        {
+            if (A.Priority != B.Priority)
+            {
+                return A.Priority > B.Priority;
+            }
+            if ((A.Deadline > 0.0) != (B.Deadline > 0.0))
+            {
+                return A.Deadline > 0.0;
+            }
+            return A.Deadline < B.Deadline;
+        });
+
+    // Every start is charged the average solve time, the first one is always allowed so a
+    // budget smaller than one solve can't stall the queue
+    const double BudgetMs = CVarGeneticPathFrameBudgetMs.GetValueOnGameThread();
+    const int32 MaxRunningQueries = FMath::Max(1, CVarGeneticPathMaxRunningQueries.GetValueOnGameThread());
+    double SpentMs = 0.0;
+    int32 NumStarted = 0;
+    while (PendingQueries.Num() > 0 && RunningQueries.Num() < MaxRunningQueries)
+    {
+        if (NumStarted > 0 && SpentMs + EstimatedSolveMs > BudgetMs)
+        {
+            break;
+        }
+
+        TUniquePtr<FRunningQuery> Running = MakeUnique<FRunningQuery>();
+        Running->Query = MoveTemp(PendingQueries[0]);
+        PendingQueries.RemoveAt(0);
+
+        // Points of a query queued before a graph change may be gone
+        if (!LinkGraph->IsValidNode(Running->Query.StartIndex) || !LinkGraph->IsValidNode(Running->Query.EndIndex))
+        {
+            CompleteQuery(Running->Query, FPath());
+            continue;
+        }
+
+        Running->Graph = LinkGraph;
+        Running->Solver = MakePathSolver(Running->Query.SolverType, *Running->Graph);
+        Running->SettingsHash = GetSettingsHash(Running->Query.SolverType);
+        if (FGeneticSolverSettings* Settings = Running->Solver->GetGeneticSettings())
+        {
+            *Settings = SolverSettings;
+
+            // The GA answers with its best path so far by the earliest deadline instead of missing it.
+            // A rushed path is not what the same query without a deadline would get, so it isn't cached
+            if (Running->Query.Deadline > 0.0)
+            {
+                const double Remaining = FMath::Max(Running->Query.Deadline - GetWorld()->GetTimeSeconds(), 0.001);
+                Settings->TimeLimitSeconds = Settings->TimeLimitSeconds > 0.0 ? FMath::Min(Settings->TimeLimitSeconds, Remaining) : Remaining;
+                Running->bCacheResult = false;
+            }
+        }
+        if (Running->Query.SolverType == EPathSolverType::Hierarchical)
+        {
+            static_cast<FHierarchicalSolver*>(Running->Solver.Get())->SetHierarchy(LinkHierarchy);
+        }
+
+        // Seeded by the point pair, so the same query on the same graph gives the same path
+        const int32 Seed = static_cast<int32>(HashCombine(GetTypeHash(Running->Query.StartIndex), GetTypeHash(Running->Query.EndIndex)));
+        TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> CancelFlag = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+        Running->Handle.CancelFlag = CancelFlag;
+        Running->Handle.Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [SolverPtr = Running->Solver.Get(), Start = Running->Query.StartIndex, End = Running->Query.EndIndex, Seed, CancelFlag]()
+            {
+                return SolverPtr->Solve(Start, End, Seed, *CancelFlag);
+            });
+
+        RunningQueries.Add(MoveTemp(Running));
+        SpentMs += EstimatedSolveMs;
+        NumStarted++;
+    }
+
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Started %d path queries, %d pending, %d running."), NumStarted, PendingQueries.Num(), RunningQueries.Num());
+}
+
+void UGeneticPathSubsystem::CompleteQuery(FGeneticPathQuery& Query, const FPath& Path)
+{
+    // Waiters may queue new requests from their callback, so answer from a moved-out list
+    TArray<FGeneticPathWaiter> Waiters = MoveTemp(Query.Waiters);
+    for (FGeneticPathWaiter& Waiter : Waiters)
+    {
+        Waiter.OnComplete.ExecuteIfBound(Waiter.RequestId, Path);
+    }
+}
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GeneticSolver.h"
+#include "HierarchicalPathSolver.h"
+#include "PathGraph.h"
+#include "PathSolver.h"
+#include "GeneticPathSubsystem.generated.h"
+
+// Called on the game thread when a path query finishes, the path is empty if it expired or failed
+DECLARE_DELEGATE_TwoParams(FOnPathQueryComplete, uint32 /*RequestId*/, const FPath& /*Path*/);
+
+// One agent waiting for a query
+struct FGeneticPathWaiter
+{
+    uint32 RequestId = 0;
+
+    // World time in seconds after which this agent no longer wants the answer, 0 for none
+    double Deadline = 0.0;
+
+    FOnPathQueryComplete OnComplete;
+};
+
+// One pending or running query, identical requests share it
+struct FGeneticPathQuery
+{
+    int32 StartIndex = INDEX_NONE;
+    int32 EndIndex = INDEX_NONE;
+    EPathSolverType SolverType = EPathSolverType::Auto;
+
+    // Highest priority and earliest deadline of the waiters, used for ordering
+    float Priority = 0.0f;
+    double Deadline = 0.0;
+
+    TArray<FGeneticPathWaiter> Waiters;
+};
+
+// Key of a solved path. The points are stored lowest first, links are symmetric so the
+// reverse query is answered by the same entry
+struct FGeneticPathCacheKey
+{
+    int32 LowIndex = INDEX_NONE;
+    int32 HighIndex = INDEX_NONE;
+    uint32 GraphSnapshot = 0;
+
+    // Solver strategy and, when it runs a GA, its settings
+    uint32 SettingsHash = 0;
+
+    FGeneticPathCacheKey() = default;
+    FGeneticPathCacheKey(int32 StartIndex, int32 EndIndex, uint32 InGraphSnapshot, uint32 InSettingsHash)
+        : LowIndex(FMath::Min(StartIndex, EndIndex))
+        , HighIndex(FMath::Max(StartIndex, EndIndex))
+        , GraphSnapshot(InGraphSnapshot)
+        , SettingsHash(InSettingsHash)
+    {
+    }
+
+    bool operator==(const FGeneticPathCacheKey& Other) const
+    {
+        return LowIndex == Other.LowIndex && HighIndex == Other.HighIndex && GraphSnapshot == Other.GraphSnapshot && SettingsHash == Other.SettingsHash;
+    }
+
+    friend uint32 GetTypeHash(const FGeneticPathCacheKey& Key)
+    {
+        return HashCombine(HashCombine(GetTypeHash(Key.LowIndex), GetTypeHash(Key.HighIndex)), HashCombine(GetTypeHash(Key.GraphSnapshot), Key.SettingsHash));
+    }
+};
+
+// Path queries for any number of agents on one shared link graph. Requests are queued by
+// priority and deadline, identical ones are merged, and background solves are only started
+// as far as the per-frame budget (GeneticPath.FrameBudgetMs) allows.
+UCLASS()
+class MYPROJECT2_API UGeneticPathSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+    // Function to publish a new snapshot of the link graph, running solves keep the one they started on.
+    // A new graph version drops every cached path
+    void SetLinkGraph(const FPathGraph& InGraph);
+
+    const FPathGraph* GetLinkGraph() const { return LinkGraph.Get(); }
+
+    // Function to queue a path query between two graph points, returns its request id (0 if rejected).
+    // A cached path is handed to OnComplete before this returns
+    uint32 RequestPath(int32 StartIndex, int32 EndIndex, float Priority, double Deadline, FOnPathQueryComplete OnComplete, EPathSolverType SolverType = EPathSolverType::Auto);
+
+    // Same, from the graph points closest to two locations
+    uint32 RequestPath(const FVector& Start, const FVector& End, float Priority, double Deadline, FOnPathQueryComplete OnComplete, EPathSolverType SolverType = EPathSolverType::Auto);
+
+    // Function to drop a request, its callback is not called
+    void CancelRequest(uint32 RequestId);
+
+    int32 GetNumPendingQueries() const { return PendingQueries.Num(); }
+    int32 GetNumRunningQueries() const { return RunningQueries.Num(); }
+
+    // Settings every genetic query's solver starts with, also used by the GA inside hierarchical queries
+    FGeneticSolverSettings SolverSettings;
+
+protected:
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+    // A query being solved on the task system, it keeps the graph snapshot it runs on alive
+    struct FRunningQuery
+    {
+        FGeneticPathQuery Query;
+        TSharedPtr<const FPathGraph, ESPMode::ThreadSafe> Graph;
+        TUniquePtr<IPathSolver> Solver;
+        uint32 SettingsHash = 0;
+        bool bCacheResult = true;
+        FGeneticSolveHandle Handle;
+    };
+
+    // Functions for the tick stages
+    void CollectFinishedQueries();
+    void DropExpiredWaiters(double Now);
+    void StartQueries();
+
+    // Function to answer and clear every waiter of a query
+    static void CompleteQuery(FGeneticPathQuery& Query, const FPath& Path);
+
+    // Function to look up a solved path in the requested direction, false on a miss
+    bool FindCachedPath(int32 StartIndex, int32 EndIndex, EPathSolverType SolverType, FPath& OutPath);
+
+    // Function to key the cache by strategy, and by settings when a GA runs
+    uint32 GetSettingsHash(EPathSolverType SolverType) const;
+
+    TSharedPtr<const FPathGraph, ESPMode::ThreadSafe> LinkGraph;
+
+    // Unique across all published graphs, graph versions only count the changes of one graph instance
+    uint32 LinkGraphSnapshot = 0;
+    TSharedPtr<FHierarchicalPathGraphCache, ESPMode::ThreadSafe> LinkHierarchy;
+
+    TArray<FGeneticPathQuery> PendingQueries;
+    TArray<TUniquePtr<FRunningQuery>> RunningQueries;
+
+    uint32 NextRequestId = 1;
+
+    // Solved paths that reached their end, least recently used dropped first
+    TLruCache<FGeneticPathCacheKey, FPath> ResultCache;
+
+    // Running average of solve times, what the budget charges for starting one more solve
+    double EstimatedSolveMs = 1.0;
+};
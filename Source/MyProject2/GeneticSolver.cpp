@@ -0,0 +1,1094 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GeneticSolver.h"
+#include "MyProject2.h"
+#include "PathFitnessKernel.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_CYCLE_STAT(TEXT("Fitness"), STAT_GeneticPath_Fitness, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Crossover"), STAT_GeneticPath_Crossover, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Mutation"), STAT_GeneticPath_Mutation, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Selection"), STAT_GeneticPath_Selection, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Local Search"), STAT_GeneticPath_LocalSearch, STATGROUP_GeneticPath);
+
+CSV_DEFINE_CATEGORY(GeneticPath, true);
+
+static TAutoConsoleVariable<bool> CVarGeneticPathVectorizedFitness(
+    TEXT("GeneticPath.VectorizedFitness"),
+    true,
+    TEXT("Score each generation with the vectorized fitness kernel, false uses the scalar loop."));
+
+namespace
+{
+    // Populations up to this size keep their per-generation scratch lists on the stack
+    constexpr int32 InlinePopulationSize = GENETIC_PATH_FIXED_POPULATION_SIZE > 0 ? GENETIC_PATH_FIXED_POPULATION_SIZE : 64;
+
+    // Paths scored per fitness task, enough to amortize the task over large populations
+    constexpr int32 FitnessBatchSize = 64;
+
+#if CSV_PROFILER
+    // Per-generation counters for the GeneticPath CSV category
+    void RecordGenerationCsvStats(TConstArrayView<FPathPopulation> Islands, int32 Evaluations, double Seconds)
+    {
+        float BestFitness = 0.0f;
+        double FitnessSum = 0.0;
+        int32 NumPaths = 0;
+        TSet<uint64> UniquePaths;
+        for (const FPathPopulation& Paths : Islands)
+        {
+            for (int32 i = 0; i < Paths.Num(); i++)
+            {
+                BestFitness = FMath::Max(BestFitness, Paths.GetFitness(i));
+                FitnessSum += Paths.GetFitness(i);
+                UniquePaths.Add(Paths.GetHash(i));
+                NumPaths++;
+            }
+        }
+
+        if (NumPaths == 0)
+        {
+            return;
+        }
+
+        CSV_CUSTOM_STAT(GeneticPath, EvaluationsPerSecond, Seconds > 0.0 ? static_cast<float>(Evaluations / Seconds) : 0.0f, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GeneticPath, BestFitness, BestFitness, ECsvCustomStatOp::Set);
+        CSV_CUSTOM_STAT(GeneticPath, MeanFitness, static_cast<float>(FitnessSum / NumPaths), ECsvCustomStatOp::Set);
+        // Share of distinct paths in the population, 1 means no duplicates
+        CSV_CUSTOM_STAT(GeneticPath, Diversity, static_cast<float>(UniquePaths.Num()) / NumPaths, ECsvCustomStatOp::Set);
+    }
+#endif
+
+    // Independent random stream for one slot of one generation
+    FRandomStream MakeRandomStream(int32 Seed, int32 Generation, int32 Slot)
+    {
+        const uint32 Hash = HashCombine(HashCombine(GetTypeHash(Seed), GetTypeHash(Generation)), GetTypeHash(Slot));
+        return FRandomStream(static_cast<int32>(Hash));
+    }
+
+    // Point to position scratch for crossover, sized to the largest graph seen on this thread.
+    // Every entry is INDEX_NONE between uses, so a use only pays for the points it touches
+    TArray<int32>& GetPointPositionScratch(int32 NumNodes)
+    {
+        static thread_local TArray<int32> Positions;
+        if (Positions.Num() < NumNodes)
+        {
+            Positions.Init(INDEX_NONE, NumNodes);
+        }
+        return Positions;
+    }
+
+    float GetBestFitness(const FPathPopulation& Paths)
+    {
+        return Paths.Num() > 0 ? Paths.GetFitness(Paths.GetRanked(0)) : 0.0f;
+    }
+
+    // Mean fitness over all islands and its spread, the standard deviation relative to the mean
+    void GetFitnessSpread(TConstArrayView<FPathPopulation> Islands, float& OutMean, float& OutDiversity)
+    {
+        double Sum = 0.0;
+        double SumSquares = 0.0;
+        int32 NumPaths = 0;
+        for (const FPathPopulation& Paths : Islands)
+        {
+            for (int32 i = 0; i < Paths.Num(); i++)
+            {
+                Sum += Paths.GetFitness(i);
+                SumSquares += FMath::Square(static_cast<double>(Paths.GetFitness(i)));
+                NumPaths++;
+            }
+        }
+
+        OutMean = NumPaths > 0 ? static_cast<float>(Sum / NumPaths) : 0.0f;
+        const double Variance = NumPaths > 0 ? FMath::Max(0.0, SumSquares / NumPaths - FMath::Square(Sum / NumPaths)) : 0.0;
+        OutDiversity = OutMean > 0.0f ? static_cast<float>(FMath::Sqrt(Variance) / OutMean) : 0.0f;
+    }
+
+    // Function to tell whether a value moved by more than a relative tolerance from a reference
+    bool HasMoved(float Value, float Reference, float Tolerance)
+    {
+        return FMath::Abs(Value - Reference) > Tolerance * FMath::Abs(Reference);
+    }
+}
+
+FString FPath::ToString(TConstArrayView<int32> PathPoints)
+{
+    FString PathString = TEXT("");
+
+    // Iterate through the points in the path and log them
+    for (int32 i = 0; i < PathPoints.Num(); i++)
+    {
+        PathString += FString::Printf(TEXT("%d"), PathPoints[i]);
+
+        if (i < PathPoints.Num() - 1)
+        {
+            PathString += TEXT(" -> ");
+        }
+    }
+
+    return PathString;
+}
+
+FGeneticSolver::FGeneticSolver(const FPathGraph& InGraph)
+    : Graph(InGraph)
+{
+}
+
+// Fitness Function: Determines how good a path is
+float FGeneticSolver::CalculateFitness(TConstArrayView<int32> Path) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_Fitness);
+
+    if (Path.Num() < 2)
+        return 0.0f;
+
+    // Calculate path length and deviation from goal
+    // Steps cost their straight length, or the link's own cost on graphs that have them (the
+    // hierarchical solver's abstract graph), a step that isn't a link falls back to its straight length
+    const float PathLength = Graph.GetPathCost(Path);
+
+    // Calculate the distance from the end point
+    float DistanceToEnd = Graph.GetSegmentLength(Path.Last(), EndIndex);
+
+    // Fitness: shorter path length and closer to the goal
+    return 1.0f / (PathLength + DistanceToEnd);  // Inversely proportional to path length + distance to goal
+}
+
+// Create a random path
+int32 FGeneticSolver::GenerateRandomPath(TArrayView<int32> OutPath, FRandomStream& Random) const
+{
+    if (!Graph.IsValidNode(StartIndex) || !Graph.IsValidNode(EndIndex))
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Start or End point is not in the graph! StartIndex: %d, EndIndex: %d"), StartIndex, EndIndex);
+        return 0;  // Handle the error (possibly exit early)
+    }
+
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Generating path from Start Index: %d to End Index: %d"), StartIndex, EndIndex);
+
+    int32 CurrentIndex = StartIndex;
+    int32 PathLength = 0;
+    // Track points that have already been added to the path, on the stack for graphs up to 2048 points
+    TBitArray<TInlineAllocator<64>> VisitedPoints(false, Graph.GetNumNodes());
+    VisitedPoints[StartIndex] = true;
+    OutPath[PathLength++] = StartIndex;
+    while (CurrentIndex != EndIndex)
+    {
+        // A walk longer than the slot is cut, it scores by how close it got to the end
+        if (PathLength == OutPath.Num())
+        {
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Path reached the maximum length of %d points! Terminating."), PathLength);
+            break;
+        }
+
+        TConstArrayView<int32> Links = Graph.GetLinks(CurrentIndex);
+
+        if (Links.Num() == 0)
+        {
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("No valid links found for point %d!"), CurrentIndex);
+            break;
+        }
+
+        // Count the unvisited points, then pick one of them without building a filtered list
+        int32 NumUnvisited = 0;
+        for (const int32 Point : Links)
+        {
+            NumUnvisited += VisitedPoints[Point] ? 0 : 1;
+        }
+
+        if (NumUnvisited == 0)
+        {
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("No unvisited links available for point %d! Terminating."), CurrentIndex);
+            break;
+        }
+
+        // Randomly select the next point from unvisited links
+        int32 Pick = Random.RandRange(0, NumUnvisited - 1);
+        int32 NextIndex = INDEX_NONE;
+        for (const int32 Point : Links)
+        {
+            if (!VisitedPoints[Point] && Pick-- == 0)
+            {
+                NextIndex = Point;
+                break;
+            }
+        }
+
+        OutPath[PathLength++] = NextIndex;
+        VisitedPoints[NextIndex] = true; // Mark the point as visited
+
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Added Point %d to Path"), NextIndex);
+
+        CurrentIndex = NextIndex; // Move to the next point
+    }
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("new generated path from generator:"));
+    LogPath(OutPath.Left(PathLength));
+    return PathLength;
+}
+
+
+
+// Select two paths for crossover
+template <typename TSelection>
+void FGeneticSolver::SelectParents(const TSelection& Selection, int32& Parent1, int32& Parent2, FRandomStream& Random) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_Selection);
+
+    // Parents are referenced by slot, their points are read in place by Crossover
+    Parent1 = Selection.Select(Random);
+    Parent2 = Selection.Select(Random);
+}
+
+// Crossover function
+int32 FGeneticSolver::Crossover(TConstArrayView<int32> Parent1, TConstArrayView<int32> Parent2, TArrayView<int32> OutChild, FRandomStream& Random) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_Crossover);
+
+    // Ensure both parents have valid paths
+    if (Parent1.Num() == 0 || Parent2.Num() == 0)
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("One of the parents has an empty path!"));
+        return 0;  // Return empty path if either parent is invalid
+    }
+
+    // Position of every point of Parent2, so each point of Parent1 is checked in O(1)
+    TArray<int32>& Positions = GetPointPositionScratch(Graph.GetNumNodes());
+    for (int32 i = Parent2.Num() - 1; i >= 0; i--)
+    {
+        Positions[Parent2[i]] = i;
+    }
+
+    // Cut only where both parents pass the same point, then the child's links are all links of a parent.
+    // The shared start is skipped, cutting there would just copy Parent2
+    int32 Cut1 = INDEX_NONE;
+    int32 Cut2 = INDEX_NONE;
+    int32 NumSharedPoints = 0;
+    for (int32 i = 1; i < Parent1.Num(); i++)
+    {
+        const int32 Position = Positions[Parent1[i]];
+        if (Position != INDEX_NONE && Random.RandRange(0, NumSharedPoints++) == 0)
+        {
+            Cut1 = i;
+            Cut2 = Position;
+        }
+    }
+
+    for (const int32 Point : Parent2)
+    {
+        Positions[Point] = INDEX_NONE;
+    }
+
+    // Parents that never meet have nothing to exchange, the child starts as a copy of Parent1
+    if (Cut1 == INDEX_NONE)
+    {
+        Cut1 = Parent1.Num() - 1;
+        Cut2 = Parent2.Num() - 1;
+    }
+
+    // Parent1 up to the cut and Parent2 after it. A point seen before closes a loop, which is cut out
+    // right away, so the child never holds a point twice. A child that fills the buffer stops there
+    int32 ChildLength = 0;
+    auto AppendPoint = [&](int32 Point)
+        {
+            const int32 Seen = Positions[Point];
+            if (Seen != INDEX_NONE)
+            {
+                for (int32 k = Seen + 1; k < ChildLength; k++)
+                {
+                    Positions[OutChild[k]] = INDEX_NONE;
+                }
+                ChildLength = Seen + 1;
+                return true;
+            }
+            if (ChildLength == OutChild.Num())
+            {
+                return false;
+            }
+            Positions[Point] = ChildLength;
+            OutChild[ChildLength++] = Point;
+            return true;
+        };
+    bool bFits = true;
+    for (int32 i = 0; i <= Cut1 && bFits; i++)
+    {
+        bFits = AppendPoint(Parent1[i]);
+    }
+    for (int32 i = Cut2 + 1; i < Parent2.Num() && bFits; i++)
+    {
+        bFits = AppendPoint(Parent2[i]);
+    }
+
+    for (int32 i = 0; i < ChildLength; i++)
+    {
+        Positions[OutChild[i]] = INDEX_NONE;
+    }
+
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Crossover at shared point %d of %d candidates."), Parent1[Cut1], NumSharedPoints);
+    return ChildLength;
+}
+
+// Mutation function: Randomly change part of the path
+void FGeneticSolver::Mutate(TArrayView<int32> Path, FRandomStream& Random, uint64& PathHash, float& PathFitness) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_Mutation);
+
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Mutation started"));
+    float RandValue = Random.FRand();
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Random Value: %f"), RandValue);
+
+    if (RandValue < Settings.MutationRate)
+    {
+        // Ensure there are points to mutate (avoid the start and end points)
+        if (Path.Num() <= 2)  // At least 2 points (start and end)
+        {
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Mutation aborted: Path has too few points."));
+            return;
+        }
+
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Mutation started 2.0"));
+
+        // Select a random mutation point (excluding start and end points)
+        int32 MutationPoint = Random.RandRange(1, Path.Num() - 2);  // Skip start (0) and end (Num()-1)
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("MutationPoint selected: %d"), MutationPoint);
+
+        int32 MutationIndex = Path[MutationPoint];
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("MutationIndex selected: %d"), MutationIndex);
+
+        // Ensure valid links exist for the mutation index
+        TConstArrayView<int32> Links = Graph.GetLinks(MutationIndex);
+        if (Links.Num() == 0)
+        {
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Mutation point %d has no valid links or links array is empty!"), MutationIndex);
+            return;
+        }
+
+        // Find a valid link for mutation
+        bool bValidLinkFound = false;
+        int32 NewPoint = -1;
+        int32 NumValidLinks = 0;
+
+        // Pick uniformly among the candidates, taking the first one always gave the same mutation
+        for (int32 i = 0; i < Links.Num(); i++)
+        {
+            int32 CandidatePoint = Links[i];
+
+            // Ensure the mutated point has valid links to both its neighbors
+            int32 PreviousPoint = Path[MutationPoint - 1];
+            int32 NextPoint = Path[MutationPoint + 1];
+
+            // A point the path already visits would close a loop
+            if (Graph.IsValidLink(PreviousPoint, CandidatePoint) && Graph.IsValidLink(CandidatePoint, NextPoint)
+                && !Path.Contains(CandidatePoint) && Random.RandRange(0, NumValidLinks++) == 0)
+            {
+                NewPoint = CandidatePoint;
+                bValidLinkFound = true;
+            }
+        }
+
+        if (!bValidLinkFound)
+        {
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("No valid links found for mutation point %d!"), MutationIndex);
+            return;
+        }
+
+        // Only the two segments around the mutated point change, so a known fitness is patched instead of re-scored
+        const int32 PreviousPoint = Path[MutationPoint - 1];
+        const int32 NextPoint = Path[MutationPoint + 1];
+        if (PathFitness > 0.0f)
+        {
+            const float LengthChange = Graph.GetLinkCost(PreviousPoint, NewPoint) + Graph.GetLinkCost(NewPoint, NextPoint)
+                - Graph.GetLinkCost(PreviousPoint, MutationIndex) - Graph.GetLinkCost(MutationIndex, NextPoint);
+            PathFitness = 1.0f / (1.0f / PathFitness + LengthChange);
+        }
+        PathHash ^= FPathPopulation::HashPoint(MutationIndex, MutationPoint) ^ FPathPopulation::HashPoint(NewPoint, MutationPoint);
+
+        // Apply the mutation
+        Path[MutationPoint] = NewPoint;
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Mutated Path at Point %d to %d"), MutationPoint, NewPoint);
+    }
+}
+
+
+
+// Memetic refinement: both moves only ever shorten the path and keep it on the link graph
+int32 FGeneticSolver::LocalSearch(TArrayView<int32> Path, int32 Budget) const
+{
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_LocalSearch);
+
+    int32 Length = Path.Num();
+    if (Length < 3)
+    {
+        return Length;
+    }
+
+    // Shortcut pass: drop a point whenever its predecessor links straight to its successor. Straight
+    // links always shorten the path, links with their own cost only when they cost less than the detour
+    int32 Kept = 1;
+    int32 Read = 1;
+    for (; Read < Length - 1 && Budget > 0; Read++, Budget--)
+    {
+        const int32 Previous = Path[Kept - 1];
+        const int32 Next = Path[Read + 1];
+        const bool bShortcut = Graph.IsValidLink(Previous, Next)
+            && (!Graph.HasLinkCosts() || Graph.GetLinkCost(Previous, Next) <= Graph.GetLinkCost(Previous, Path[Read]) + Graph.GetLinkCost(Path[Read], Next));
+        if (!bShortcut)
+        {
+            Path[Kept++] = Path[Read];
+        }
+    }
+    for (; Read < Length; Read++)
+    {
+        Path[Kept++] = Path[Read];
+    }
+    Length = Kept;
+
+    // 2-opt pass: replace links A-B and C-D by A-C and B-D, reversing B..C, when both new links exist and are shorter
+    for (int32 i = 0; i < Length - 3 && Budget > 0; i++)
+    {
+        for (int32 j = i + 2; j < Length - 1 && Budget > 0; j++, Budget--)
+        {
+            const int32 A = Path[i];
+            const int32 B = Path[i + 1];
+            const int32 C = Path[j];
+            const int32 D = Path[j + 1];
+            if (!Graph.IsValidLink(A, C) || !Graph.IsValidLink(B, D))
+            {
+                continue;
+            }
+
+            const float Gain = Graph.GetLinkCost(A, B) + Graph.GetLinkCost(C, D)
+                - Graph.GetLinkCost(A, C) - Graph.GetLinkCost(B, D);
+            if (Gain > UE_KINDA_SMALL_NUMBER)
+            {
+                Algo::Reverse(Path.GetData() + i + 1, j - i);
+            }
+        }
+    }
+
+    return Length;
+}
+
+// Fill a population with random paths
+void FGeneticSolver::InitializePopulation(FPathPopulation& Paths, int32 Seed, EParallelForFlags Flags) const
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FGeneticSolver::InitializePopulation);
+
+    // A cold solve never keeps paths from the last one: they may start elsewhere or cross links that are
+    // gone, and keeping them would make a fixed seed give a different result on every solve. Reset only
+    // reallocates when the shape changed, only Replan carries paths over
+    const int32 PopulationSize = GetPopulationSize();
+    Paths.Reset(PopulationSize, GetMaxPathLength());
+
+    // Random streams are keyed by (seed, generation, slot), never by worker, so the
+    // result for a given seed does not depend on how many threads run the loops
+    Paths.AddPaths(PopulationSize);
+    ParallelFor(PopulationSize, [&](int32 Slot)
+        {
+            FRandomStream Random = MakeRandomStream(Seed, INDEX_NONE, Slot);
+            Paths.SetPathLength(Slot, GenerateRandomPath(Paths.GetPathBuffer(Slot), Random));
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("new generated path:"));
+            LogPath(Paths.GetPath(Slot));
+        }, Flags);
+}
+
+bool FGeneticSolver::CanRepairPopulation(const FPathPopulation& Paths) const
+{
+    return Paths.Num() > 0 && Paths.GetMaxPathLength() == GetMaxPathLength() && Paths.GetMaxPaths() >= GetPopulationSize();
+}
+
+// Keep every path that still works, splice detours into the rest
+int32 FGeneticSolver::RepairPopulation(FPathPopulation& Paths, bool bEndChanged, int32 Seed, EParallelForFlags Flags) const
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FGeneticSolver::RepairPopulation);
+
+    TArray<bool, TInlineAllocator<InlinePopulationSize>> Changed;
+    Changed.SetNumZeroed(Paths.Num());
+    ParallelFor(Paths.Num(), [&](int32 Slot)
+        {
+            const TConstArrayView<int32> OldPath = Paths.GetPath(Slot);
+
+            // Last position of every point, where a detour may rejoin the old path
+            TMap<int32, int32> Positions;
+            Positions.Reserve(OldPath.Num());
+            for (int32 i = 0; i < OldPath.Num(); i++)
+            {
+                Positions.Add(OldPath[i], i);
+            }
+
+            // Walk the old path from the current start, every step that is no longer a link (or would
+            // revisit a point) is replaced by a detour to the nearest later point that can be reached
+            TArray<int32> Repaired;
+            TSet<int32> Visited;
+            TArray<int32> Detour;
+            Repaired.Add(StartIndex);
+            Visited.Add(StartIndex);
+            int32 Position = OldPath.Num() > 0 && OldPath[0] == StartIndex ? 1 : 0;
+            bool bPathChanged = Position == 0;
+            while (Position < OldPath.Num() && Repaired.Last() != EndIndex)
+            {
+                const int32 Next = OldPath[Position];
+                if (!Visited.Contains(Next) && Graph.IsValidLink(Repaired.Last(), Next))
+                {
+                    Repaired.Add(Next);
+                    Visited.Add(Next);
+                    Position++;
+                    continue;
+                }
+
+                bPathChanged = true;
+                int32 RejoinPosition = INDEX_NONE;
+                if (!FindDetour(Repaired.Last(), Positions, Position, Visited, Detour, RejoinPosition))
+                {
+                    // Nothing reachable nearby, keep the part that still works
+                    break;
+                }
+
+                for (int32 Point : Detour)
+                {
+                    Repaired.Add(Point);
+                    Visited.Add(Point);
+                }
+                Repaired.Add(OldPath[RejoinPosition]);
+                Visited.Add(OldPath[RejoinPosition]);
+                Position = RejoinPosition + 1;
+            }
+
+            // Whatever followed the end or a dead end is dropped
+            bPathChanged |= Position < OldPath.Num();
+            Changed[Slot] = bPathChanged;
+
+            if (!bPathChanged)
+            {
+                if (bEndChanged)
+                {
+                    Paths.SetFitness(Slot, FPathPopulation::UnscoredFitness);
+                }
+            }
+            else if (Repaired.Num() > 1)
+            {
+                // Detours can make the path longer than its slot, the cut part scores as unfinished
+                Paths.SetPath(Slot, MakeArrayView(Repaired).Left(Paths.GetMaxPathLength()));
+            }
+            else
+            {
+                // Not even the first step could be saved
+                FRandomStream Random = MakeRandomStream(Seed, INDEX_NONE, Slot);
+                Paths.SetPathLength(Slot, GenerateRandomPath(Paths.GetPathBuffer(Slot), Random));
+            }
+        }, Flags);
+
+    int32 NumChanged = 0;
+    for (bool bChanged : Changed)
+    {
+        NumChanged += bChanged ? 1 : 0;
+    }
+    return NumChanged;
+}
+
+// Breadth-first, so the detour takes as few links as possible, and bounded so a replan stays local
+bool FGeneticSolver::FindDetour(int32 From, const TMap<int32, int32>& Targets, int32 MinPosition, const TSet<int32>& Avoid, TArray<int32>& OutDetour, int32& OutPosition) const
+{
+    OutDetour.Reset();
+
+    TMap<int32, int32> Parents;
+    TArray<int32> Queue;
+    Parents.Add(From, INDEX_NONE);
+    Queue.Add(From);
+    const int32 SearchLimit = FMath::Max(1, Settings.RepairSearchLimit);
+    for (int32 Head = 0; Head < Queue.Num() && Parents.Num() <= SearchLimit; Head++)
+    {
+        const int32 Point = Queue[Head];
+        for (int32 Next : Graph.GetLinks(Point))
+        {
+            if (Parents.Contains(Next) || Avoid.Contains(Next))
+            {
+                continue;
+            }
+            Parents.Add(Next, Point);
+
+            const int32* Position = Targets.Find(Next);
+            if (Position && *Position >= MinPosition)
+            {
+                // The points between From and the target, in walking order
+                for (int32 Step = Point; Step != From; Step = Parents[Step])
+                {
+                    OutDetour.Add(Step);
+                }
+                Algo::Reverse(OutDetour);
+                OutPosition = *Position;
+                return true;
+            }
+            Queue.Add(Next);
+        }
+    }
+    return false;
+}
+
+// Score every unscored path and rank the population, best first. Returns the number of full evaluations
+int32 FGeneticSolver::EvaluatePopulation(FPathPopulation& Paths, FPathFitnessCache& Cache, EParallelForFlags Flags) const
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FGeneticSolver::EvaluatePopulation);
+
+    // Collect the individuals that elitism, the cache or mutation did not already score
+    TArray<int32, TInlineAllocator<InlinePopulationSize>> UnscoredSlots;
+    for (int32 i = 0; i < Paths.Num(); i++)
+    {
+        if (Paths.IsScored(i))
+        {
+            continue;
+        }
+
+        if (const float* CachedFitness = Cache.Find(Paths.GetHash(i)))
+        {
+            Paths.SetFitness(i, *CachedFitness);
+            continue;
+        }
+
+        UnscoredSlots.Add(i);
+    }
+
+    // Score the rest a batch at a time, same formula as CalculateFitness
+    const bool bVectorized = CVarGeneticPathVectorizedFitness.GetValueOnAnyThread();
+    ParallelFor(FMath::DivideAndRoundUp(UnscoredSlots.Num(), FitnessBatchSize), [&](int32 Batch)
+        {
+            SCOPE_CYCLE_COUNTER(STAT_GeneticPath_Fitness);
+            const TConstArrayView<int32> BatchSlots = MakeArrayView(UnscoredSlots).Mid(Batch * FitnessBatchSize, FitnessBatchSize);
+            FPathFitnessKernel::ScorePaths(Graph, EndIndex, Paths, BatchSlots, bVectorized);
+        }, Flags);
+
+    // Remember this generation's scores, on one thread so the cache needs no lock
+    for (int32 i = 0; i < Paths.Num(); i++)
+    {
+        Cache.Add(Paths.GetHash(i), Paths.GetFitness(i));
+    }
+
+    // Rank the population by fitness (best first), the paths themselves stay in their slots
+    Paths.SortByFitness();
+    return UnscoredSlots.Num();
+}
+
+// Write the next generation of a ranked population into its back buffer and swap
+template <typename TSelection>
+void FGeneticSolver::BreedPopulation(FPathPopulation& Paths, FPathFitnessCache& Cache, const TSelection& Selection, int32 Seed, int32 Generation, EParallelForFlags Flags) const
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FGeneticSolver::BreedPopulation);
+
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("population[0]:"));
+    LogPath(Paths.GetPath(Paths.GetRanked(0)));
+    UE_LOG(LogGeneticPath, VeryVerbose, TEXT("population[1]:"));
+    LogPath(Paths.GetPath(Paths.GetRanked(1)));
+
+    // Elitism: Keep the top 2 paths
+    const int32 NumElites = 2;
+    const int32 PopulationSize = FMath::Max(GetPopulationSize(), NumElites);
+    Paths.BeginNextGeneration(PopulationSize);
+    for (int32 Elite = 0; Elite < NumElites; Elite++)
+    {
+        Paths.CopyToNext(Elite, Paths.GetRanked(Elite));
+    }
+
+    // The local search budget is split evenly so every slot gets the same share on any thread count
+    const int32 NumChildren = PopulationSize - NumElites;
+    const int32 LocalSearchBudget = Settings.LocalSearchBudget > 0 ? FMath::Max(1, Settings.LocalSearchBudget / FMath::Max(NumChildren, 1)) : 0;
+
+    // Create new paths by crossover and mutation, each slot is independent and
+    // children are written straight into their slot of the next generation
+    ParallelFor(NumChildren, [&](int32 i)
+        {
+            const int32 Slot = NumElites + i;
+            FRandomStream Random = MakeRandomStream(Seed, Generation, Slot);
+
+            int32 Parent1, Parent2;
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Before SelectParents"));
+            SelectParents(Selection, Parent1, Parent2, Random);
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Before crossover"));
+            TArrayView<int32> Child = Paths.GetNextPathBuffer(Slot);
+            int32 ChildLength = Crossover(Paths.GetPath(Parent1), Paths.GetPath(Parent2), Child, Random);
+            Child = Child.Left(ChildLength);
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Child after crossover:"));
+            LogPath(Child);
+
+            // A child that repeats a known path takes its score from the cache, mutation then patches it
+            uint64 ChildHash = FPathPopulation::HashPath(Child);
+            const float* CachedFitness = Cache.Find(ChildHash);
+            float ChildFitness = CachedFitness ? *CachedFitness : FPathPopulation::UnscoredFitness;
+
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Before child mutated:"));
+            Mutate(Child, Random, ChildHash, ChildFitness);
+            UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Child after mutation:"));
+            LogPath(Child);
+
+            if (LocalSearchBudget > 0)
+            {
+                ChildLength = LocalSearch(Child, LocalSearchBudget);
+                UE_LOG(LogGeneticPath, VeryVerbose, TEXT("Child after local search:"));
+                LogPath(Child.Left(ChildLength));
+
+                const uint64 RefinedHash = FPathPopulation::HashPath(Child.Left(ChildLength));
+                if (RefinedHash != ChildHash)
+                {
+                    ChildHash = RefinedHash;
+                    ChildFitness = FPathPopulation::UnscoredFitness;
+                }
+            }
+
+            Paths.SetNextPath(Slot, ChildLength, ChildHash, ChildFitness);
+        }, Flags);
+
+    // Duplicates add nothing but weight in selection, replace them with fresh random paths.
+    // Found on one thread in slot order so the elites win and the result stays deterministic
+    TArray<int32, TInlineAllocator<InlinePopulationSize>> DuplicateSlots;
+    Cache.SeenHashes.Reset();
+    for (int32 Slot = 0; Slot < Paths.GetNextNum(); Slot++)
+    {
+        bool bAlreadySeen = false;
+        Cache.SeenHashes.Add(Paths.GetNextHash(Slot), &bAlreadySeen);
+        if (bAlreadySeen)
+        {
+            DuplicateSlots.Add(Slot);
+        }
+    }
+    ParallelFor(DuplicateSlots.Num(), [&](int32 i)
+        {
+            const int32 Slot = DuplicateSlots[i];
+            FRandomStream Random = MakeRandomStream(Seed, Generation, Paths.GetNextNum() + Slot);
+            TArrayView<int32> FreshPath = Paths.GetNextPathBuffer(Slot);
+            const int32 FreshLength = GenerateRandomPath(FreshPath, Random);
+            Paths.SetNextPath(Slot, FreshLength, FPathPopulation::HashPath(FreshPath.Left(FreshLength)));
+        }, Flags);
+
+    // The new generation becomes current, the old buffer is reused for the next one
+    Paths.SwapGenerations();
+}
+
+// Ring migration: every island's best paths replace the worst paths of the next island
+void FGeneticSolver::MigrateIslands()
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FGeneticSolver::MigrateIslands);
+
+    const int32 NumIslands = Islands.Num();
+    int32 Count = FMath::Max(0, Settings.MigrantCount);
+    for (const FPathPopulation& Island : Islands)
+    {
+        Count = FMath::Min(Count, Island.Num() - 1);
+    }
+    if (Count <= 0)
+    {
+        return;
+    }
+
+    // Copy all migrants out first so an island never receives its own paths back,
+    // the scratch buffer only reallocates when the island shape changes
+    Migrants.Reset(NumIslands * Count, GetMaxPathLength());
+    Migrants.AddPaths(NumIslands * Count);
+    for (int32 Island = 0; Island < NumIslands; Island++)
+    {
+        const FPathPopulation& Source = Islands[Island];
+        for (int32 i = 0; i < Count; i++)
+        {
+            Migrants.SetPath(Island * Count + i, Source.GetPath(Source.GetRanked(i)));
+            Migrants.SetFitness(Island * Count + i, Source.GetFitness(Source.GetRanked(i)));
+        }
+    }
+
+    for (int32 Island = 0; Island < NumIslands; Island++)
+    {
+        FPathPopulation& Target = Islands[Island];
+        const int32 SourceIsland = (Island + NumIslands - 1) % NumIslands;
+        for (int32 i = 0; i < Count; i++)
+        {
+            const int32 Slot = Target.GetRanked(Target.Num() - 1 - i);
+            Target.SetPath(Slot, Migrants.GetPath(SourceIsland * Count + i));
+            Target.SetFitness(Slot, Migrants.GetFitness(SourceIsland * Count + i));
+        }
+
+        // Migrants carry their fitness, so a rerank is enough
+        Target.SortByFitness();
+    }
+}
+
+template <typename TSelection>
+int64 FGeneticSolver::EvolveIsland(TSelection Selection, int32 Island, int32 Seed, int32 FirstGeneration, int32 NumSteps, double Deadline, EParallelForFlags Flags, const std::atomic<bool>& bCancelRequested)
+{
+    int64 Evaluations = 0;
+    for (int32 Step = 0; Step < NumSteps; Step++)
+    {
+        if (bCancelRequested.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        // The first step was already checked against the deadline by Solve
+        if (Step > 0 && Deadline > 0.0 && FPlatformTime::Seconds() >= Deadline)
+        {
+            break;
+        }
+
+        Selection.Prepare(Islands[Island]);
+        BreedPopulation(Islands[Island], FitnessCaches[Island], Selection, Seed, FirstGeneration + Step, Flags);
+        Evaluations += EvaluatePopulation(Islands[Island], FitnessCaches[Island], Flags);
+    }
+    return Evaluations;
+}
+
+int64 FGeneticSolver::EvolveIsland(int32 Island, int32 Seed, int32 FirstGeneration, int32 NumSteps, double Deadline, EParallelForFlags Flags, const std::atomic<bool>& bCancelRequested)
+{
+    switch (Settings.Selection)
+    {
+    case EGeneticSelectionType::Tournament:
+        return EvolveIsland(FTournamentSelection(Settings.TournamentSize), Island, Seed, FirstGeneration, NumSteps, Deadline, Flags, bCancelRequested);
+    case EGeneticSelectionType::Rank:
+        return EvolveIsland(FRankSelection(), Island, Seed, FirstGeneration, NumSteps, Deadline, Flags, bCancelRequested);
+    case EGeneticSelectionType::Roulette:
+        return EvolveIsland(FRouletteSelection(), Island, Seed, FirstGeneration, NumSteps, Deadline, Flags, bCancelRequested);
+    default:
+        return EvolveIsland(FUniformSelection(), Island, Seed, FirstGeneration, NumSteps, Deadline, Flags, bCancelRequested);
+    }
+}
+
+void FGeneticSolver::PublishProgress(const FPathPopulation& Paths) const
+{
+    if (!OnProgress.IsBound() || Paths.Num() == 0)
+    {
+        return;
+    }
+
+    FPath BestPath;
+    const TConstArrayView<int32> BestPoints = Paths.GetPath(Paths.GetRanked(0));
+    BestPath.PathPoints.Append(BestPoints.GetData(), BestPoints.Num());
+    BestPath.Fitness = Paths.GetFitness(Paths.GetRanked(0));
+    OnProgress.Execute(BestPath);
+}
+
+FPath FGeneticSolver::Solve(int32 InStartIndex, int32 InEndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested)
+{
+    return RunSolve(InStartIndex, InEndIndex, Seed, false, bCancelRequested);
+}
+
+FPath FGeneticSolver::Replan(int32 InStartIndex, int32 InEndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested)
+{
+    return RunSolve(InStartIndex, InEndIndex, Seed, true, bCancelRequested);
+}
+
+// The main Genetic Algorithm
+FPath FGeneticSolver::RunSolve(int32 InStartIndex, int32 InEndIndex, int32 Seed, bool bWarmStart, const std::atomic<bool>& bCancelRequested)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FGeneticSolver::Solve);
+
+    const bool bEndChanged = EndIndex != InEndIndex;
+    StartIndex = InStartIndex;
+    EndIndex = InEndIndex;
+    Stats = FGeneticSolveStats();
+    const double SolveStartTime = FPlatformTime::Seconds();
+
+    if (!Graph.IsValidNode(StartIndex) || !Graph.IsValidNode(EndIndex))
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Start or End point is not in the graph! StartIndex: %d, EndIndex: %d"), StartIndex, EndIndex);
+        return FPath();
+    }
+
+    // Absolute time the solve has to stop by, 0 for none
+    const double Deadline = Settings.TimeLimitSeconds > 0.0 ? SolveStartTime + Settings.TimeLimitSeconds : 0.0;
+
+    // Generation and value at which the best and the mean fitness last moved by more than the tolerance
+    const int32 ConvergenceWindow = FMath::Max(1, Settings.ConvergenceWindow);
+    const float ConvergenceTolerance = FMath::Max(0.0f, Settings.ConvergenceTolerance);
+    float PlateauBest = 0.0f;
+    float PlateauMean = 0.0f;
+    int32 BestPlateauStart = 0;
+    int32 MeanPlateauStart = 0;
+
+    // With several islands each one evolves on its own worker for a whole migration
+    // interval, the loops inside an island then stay on that worker
+    const int32 NumIslands = FMath::Max(1, Settings.IslandCount);
+    const int32 EpochLength = NumIslands > 1 ? FMath::Max(1, Settings.MigrationInterval) : 1;
+    const EParallelForFlags IslandFlags = NumIslands > 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+
+    // Island 0 keeps the plain seed so a single island behaves like a plain GA. Every island keeps
+    // its own buffer between solves, a warm start its paths too
+    Islands.SetNum(NumIslands);
+
+    // Cached scores belong to the last start, end and graph
+    FitnessCaches.SetNum(NumIslands);
+    for (FPathFitnessCache& Cache : FitnessCaches)
+    {
+        Cache.Reset(FMath::Max(Settings.FitnessCacheSize, 0));
+    }
+
+    // Full evaluations per island, each island only writes its own entry
+    TArray<int64, TInlineAllocator<16>> IslandEvaluations;
+    IslandEvaluations.SetNumZeroed(NumIslands);
+    auto CollectEvaluations = [&IslandEvaluations]()
+        {
+            int64 Evaluations = 0;
+            for (int64& Count : IslandEvaluations)
+            {
+                Evaluations += Count;
+                Count = 0;
+            }
+            return Evaluations;
+        };
+    auto GetIslandSeed = [Seed](int32 Island)
+        {
+            return Island == 0 ? Seed : static_cast<int32>(HashCombine(GetTypeHash(Seed), GetTypeHash(Island)));
+        };
+
+    // Initialize population with random paths, a warm start repairs the paths it still has instead
+    TArray<int32, TInlineAllocator<16>> IslandRepairs;
+    IslandRepairs.SetNumZeroed(NumIslands);
+    ParallelFor(NumIslands, [&](int32 Island)
+        {
+            if (bWarmStart && CanRepairPopulation(Islands[Island]))
+            {
+                IslandRepairs[Island] = RepairPopulation(Islands[Island], bEndChanged, GetIslandSeed(Island), IslandFlags);
+            }
+            else
+            {
+                InitializePopulation(Islands[Island], GetIslandSeed(Island), IslandFlags);
+            }
+            IslandEvaluations[Island] += EvaluatePopulation(Islands[Island], FitnessCaches[Island], IslandFlags);
+        });
+    Stats.Evaluations += CollectEvaluations();
+    for (int32 Repairs : IslandRepairs)
+    {
+        Stats.RepairedPaths += Repairs;
+    }
+    if (bWarmStart)
+    {
+        UE_LOG(LogGeneticPath, Log, TEXT("Replan from %d to %d repaired %d paths."), StartIndex, EndIndex, Stats.RepairedPaths);
+    }
+
+    // Evolve population over generations
+    int32 BestIsland = 0;
+    const int32 MaxGenerations = FMath::Max(0, Settings.MaxGenerations);
+    for (int Gen = 0; Gen < MaxGenerations; Gen += EpochLength)
+    {
+        if (bCancelRequested.load(std::memory_order_relaxed))
+        {
+            UE_LOG(LogGeneticPath, Log, TEXT("Genetic solve cancelled at generation %d."), Gen);
+            Stats.StopReason = EGeneticStopReason::Cancelled;
+            Stats.Seconds = FPlatformTime::Seconds() - SolveStartTime;
+            return FPath();
+        }
+
+        // Find the island holding the best path
+        BestIsland = 0;
+        for (int32 Island = 1; Island < NumIslands; Island++)
+        {
+            if (GetBestFitness(Islands[Island]) > GetBestFitness(Islands[BestIsland]))
+            {
+                BestIsland = Island;
+            }
+        }
+
+        // Track fitness changes, every improvement is handed out right away
+        const float CurrentBestFitness = GetBestFitness(Islands[BestIsland]);
+        if (CurrentBestFitness > Stats.BestFitness)
+        {
+            Stats.BestFitness = CurrentBestFitness;
+            Stats.GenerationsToBest = Gen;
+            Stats.SecondsToBest = FPlatformTime::Seconds() - SolveStartTime;
+            PublishProgress(Islands[BestIsland]);
+        }
+        OnPopulationProgress.ExecuteIfBound(Islands);
+
+        float MeanFitness = 0.0f;
+        float Diversity = 0.0f;
+        GetFitnessSpread(Islands, MeanFitness, Diversity);
+        UE_LOG(LogGeneticPath, Verbose, TEXT("Generation %d: Best Fitness = %f, Mean Fitness = %f, Diversity = %f"), Gen, CurrentBestFitness, MeanFitness, Diversity);
+
+        if (Settings.TargetFitness > 0.0f && CurrentBestFitness >= Settings.TargetFitness)
+        {
+            UE_LOG(LogGeneticPath, Log, TEXT("Stopping at generation %d, target fitness %f reached."), Gen, Settings.TargetFitness);
+            Stats.StopReason = EGeneticStopReason::TargetFitness;
+            break;
+        }
+
+        if (Deadline > 0.0 && FPlatformTime::Seconds() >= Deadline)
+        {
+            UE_LOG(LogGeneticPath, Log, TEXT("Stopping at generation %d, time limit of %.2f ms reached."), Gen, Settings.TimeLimitSeconds * 1000.0);
+            Stats.StopReason = EGeneticStopReason::TimeLimit;
+            break;
+        }
+
+        // Small fluctuations don't restart a plateau, only moves beyond the tolerance do
+        if (Gen == 0 || CurrentBestFitness > PlateauBest * (1.0f + ConvergenceTolerance))
+        {
+            PlateauBest = CurrentBestFitness;
+            BestPlateauStart = Gen;
+        }
+        if (Gen == 0 || HasMoved(MeanFitness, PlateauMean, ConvergenceTolerance))
+        {
+            PlateauMean = MeanFitness;
+            MeanPlateauStart = Gen;
+        }
+
+        // Converged once the best stalled and the rest of the population either settled or collapsed onto it
+        const bool bBestSettled = Gen - BestPlateauStart >= ConvergenceWindow;
+        const bool bMeanSettled = Gen - MeanPlateauStart >= ConvergenceWindow;
+        if (bBestSettled && (bMeanSettled || Diversity < Settings.MinDiversity))
+        {
+            UE_LOG(LogGeneticPath, Log, TEXT("Stopping at generation %d, converged (best %f, mean %f, diversity %f)."), Gen, CurrentBestFitness, MeanFitness, Diversity);
+            Stats.StopReason = EGeneticStopReason::Converged;
+            break;
+        }
+
+        if (NumIslands > 1 && Gen > 0)
+        {
+            MigrateIslands();
+        }
+
+        const int32 NumSteps = FMath::Min(EpochLength, MaxGenerations - Gen);
+#if CSV_PROFILER
+        const double EpochStartTime = FPlatformTime::Seconds();
+#endif
+        ParallelFor(NumIslands, [&](int32 Island)
+            {
+                IslandEvaluations[Island] += EvolveIsland(Island, GetIslandSeed(Island), Gen, NumSteps, Deadline, IslandFlags, bCancelRequested);
+            });
+
+        Stats.Generations += NumSteps;
+        const int64 EpochEvaluations = CollectEvaluations();
+        Stats.Evaluations += EpochEvaluations;
+
+#if CSV_PROFILER
+        if (FCsvProfiler::Get()->IsCapturing())
+        {
+            RecordGenerationCsvStats(Islands, static_cast<int32>(EpochEvaluations), FPlatformTime::Seconds() - EpochStartTime);
+        }
+#endif
+    }
+
+    // Islands are ranked after every step, so the best path leads one of them
+    for (int32 Island = 1; Island < NumIslands; Island++)
+    {
+        if (GetBestFitness(Islands[Island]) > GetBestFitness(Islands[BestIsland]))
+        {
+            BestIsland = Island;
+        }
+    }
+    Stats.Seconds = FPlatformTime::Seconds() - SolveStartTime;
+
+    // The only copy out of the gene buffer, once per solve. The islands stay where they are for a replan
+    const FPathPopulation& BestPopulation = Islands[BestIsland];
+    FPath BestPath;
+    if (BestPopulation.Num() > 0)
+    {
+        const TConstArrayView<int32> BestPoints = BestPopulation.GetPath(BestPopulation.GetRanked(0));
+        BestPath.PathPoints.Append(BestPoints.GetData(), BestPoints.Num());
+        BestPath.Fitness = BestPopulation.GetFitness(BestPopulation.GetRanked(0));
+    }
+    return BestPath;
+}
+
+void FGeneticSolver::LogPath(TConstArrayView<int32> Path)
+{
+    // Skip building the string unless someone will see it
+    if (UE_LOG_ACTIVE(LogGeneticPath, VeryVerbose))
+    {
+        UE_LOG(LogGeneticPath, VeryVerbose, TEXT("%s"), *FPath::ToString(Path));
+    }
+}
@@ -0,0 +1,331 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "Math/RandomStream.h"
+#include "Misc/ScopeLock.h"
+#include "PathGraph.h"
+#include "PathSolver.h"
+#include "PathPopulation.h"
+#include "PathSelection.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+// Population size baked in at compile time (e.g. from the module's PublicDefinitions),
+// 0 reads FGeneticSolverSettings::PopulationSize at runtime
+#ifndef GENETIC_PATH_FIXED_POPULATION_SIZE
+#define GENETIC_PATH_FIXED_POPULATION_SIZE 0
+#endif
+
+struct MYPROJECT2_API FPath
+{
+    TArray<int32> PathPoints; // List of point indices representing the path
+    float Fitness;             // Fitness of the path
+
+    FPath() : Fitness(0.0f) {} // Default constructor
+
+    // "0 -> 4 -> 7" style listing for logs
+    FString ToString() const { return ToString(PathPoints); }
+    static FString ToString(TConstArrayView<int32> Points);
+};
+
+// Latest improved path of a running solve, written by the solving thread and taken by the game thread
+struct FGeneticSolveProgress
+{
+    void Publish(const FPath& Path)
+    {
+        FScopeLock Lock(&CriticalSection);
+        BestPath = Path;
+        bHasUpdate = true;
+    }
+
+    // Function to take the path published since the last call, false if there is none
+    bool Consume(FPath& OutPath)
+    {
+        FScopeLock Lock(&CriticalSection);
+        if (!bHasUpdate)
+        {
+            return false;
+        }
+        OutPath = MoveTemp(BestPath);
+        bHasUpdate = false;
+        return true;
+    }
+
+    // Same for the population's link usage, see FPathDebugDraw::CountEdgeUsage
+    void PublishEdgeUsage(TArray<int32>&& Usage)
+    {
+        FScopeLock Lock(&CriticalSection);
+        EdgeUsage = MoveTemp(Usage);
+        bHasEdgeUsage = true;
+    }
+
+    bool ConsumeEdgeUsage(TArray<int32>& OutUsage)
+    {
+        FScopeLock Lock(&CriticalSection);
+        if (!bHasEdgeUsage)
+        {
+            return false;
+        }
+        Swap(OutUsage, EdgeUsage);
+        bHasEdgeUsage = false;
+        return true;
+    }
+
+private:
+    FCriticalSection CriticalSection;
+    FPath BestPath;
+    TArray<int32> EdgeUsage;
+    bool bHasUpdate = false;
+    bool bHasEdgeUsage = false;
+};
+
+// Handle to a genetic solve running on the task system
+struct FGeneticSolveHandle
+{
+    UE::Tasks::TTask<FPath> Task;
+    TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> CancelFlag;
+
+    // Set when the caller wants the best-so-far paths of the solve
+    TSharedPtr<FGeneticSolveProgress, ESPMode::ThreadSafe> Progress;
+
+    bool IsValid() const { return Task.IsValid(); }
+    bool IsCompleted() const { return Task.IsValid() && Task.IsCompleted(); }
+    bool IsCancelled() const { return CancelFlag.IsValid() && CancelFlag->load(std::memory_order_relaxed); }
+
+    // Ask the solver to stop at the next generation boundary
+    void Cancel()
+    {
+        if (CancelFlag.IsValid())
+        {
+            CancelFlag->store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void Reset()
+    {
+        Task = UE::Tasks::TTask<FPath>();
+        CancelFlag.Reset();
+        Progress.Reset();
+    }
+};
+
+struct FGeneticSolverSettings
+{
+    // Paths per population, ignored when GENETIC_PATH_FIXED_POPULATION_SIZE is set
+    int32 PopulationSize = 20;
+
+    // Chance that a child gets one point mutated
+    float MutationRate = 0.05f;
+
+    int32 MaxGenerations = 1000;
+
+    // Parent selection, and the number of paths competing in each tournament
+    EGeneticSelectionType Selection = EGeneticSelectionType::Tournament;
+    int32 TournamentSize = 3;
+
+    // Number of independent populations evolved in parallel, 1 runs a single population
+    int32 IslandCount = 1;
+
+    // Generations between migrations when IslandCount > 1
+    int32 MigrationInterval = 10;
+
+    // Best paths each island sends to its neighbor on every migration
+    int32 MigrantCount = 2;
+
+    // Link checks per generation the local search may spend on offspring, 0 turns it off
+    int32 LocalSearchBudget = 0;
+
+    // Fitness values each island remembers by path hash, so repeated paths are not re-scored
+    int32 FitnessCacheSize = 4096;
+
+    // Points a replan may visit while searching a detour around one broken link
+    int32 RepairSearchLimit = 256;
+
+    // Points every path slot holds, longer paths are cut and score as unfinished. Keeps the population
+    // buffers at PopulationSize x MaxPathLength instead of PopulationSize x points. 0 for the graph's size
+    int32 MaxPathLength = 1024;
+
+    // Wall-clock budget of one solve in seconds, the best path so far is returned when it runs out. 0 for none
+    double TimeLimitSeconds = 0.0;
+
+    // Stop as soon as a path is at least this fit, 0 for none
+    float TargetFitness = 0.0f;
+
+    // Converged once the best fitness improved by no more than ConvergenceTolerance (relative) for
+    // ConvergenceWindow generations, and the mean fitness settled the same way or the population's
+    // fitness spread (standard deviation over mean) fell below MinDiversity
+    int32 ConvergenceWindow = 20;
+    float ConvergenceTolerance = 0.001f;
+    float MinDiversity = 0.01f;
+
+    // Hash of everything that can change a solve's result, used to key cached paths
+    friend uint32 GetTypeHash(const FGeneticSolverSettings& Settings)
+    {
+        uint32 Hash = GetTypeHash(Settings.PopulationSize);
+        Hash = HashCombine(Hash, GetTypeHash(Settings.MutationRate));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.MaxGenerations));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.Selection));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.TournamentSize));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.IslandCount));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.MigrationInterval));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.MigrantCount));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.LocalSearchBudget));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.TimeLimitSeconds));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.TargetFitness));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.ConvergenceWindow));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.ConvergenceTolerance));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.MinDiversity));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.RepairSearchLimit));
+        Hash = HashCombine(Hash, GetTypeHash(Settings.MaxPathLength));
+        return Hash;
+    }
+};
+
+// Why a genetic solve stopped
+enum class EGeneticStopReason : uint8
+{
+    MaxGenerations,
+    Converged,
+    TargetFitness,
+    TimeLimit,
+    Cancelled,
+};
+
+inline const TCHAR* LexToString(EGeneticStopReason Reason)
+{
+    switch (Reason)
+    {
+    case EGeneticStopReason::Converged: return TEXT("Converged");
+    case EGeneticStopReason::TargetFitness: return TEXT("TargetFitness");
+    case EGeneticStopReason::TimeLimit: return TEXT("TimeLimit");
+    case EGeneticStopReason::Cancelled: return TEXT("Cancelled");
+    default: return TEXT("MaxGenerations");
+    }
+}
+
+// Called on the solving thread once per epoch with every island, for views of the whole population
+DECLARE_DELEGATE_OneParam(FOnGeneticPopulationProgress, TConstArrayView<FPathPopulation> /*Islands*/);
+
+// Counters from the last Solve, for benchmarks and profiling
+struct FGeneticSolveStats
+{
+    int32 Generations = 0;
+
+    // Full CalculateFitness calls, cached and patched scores are not counted
+    int64 Evaluations = 0;
+    double Seconds = 0.0;
+
+    // When the final best fitness was first reached
+    int32 GenerationsToBest = 0;
+    double SecondsToBest = 0.0;
+    float BestFitness = 0.0f;
+
+    EGeneticStopReason StopReason = EGeneticStopReason::MaxGenerations;
+
+    // Paths a replan had to change to fit the new graph, start and end
+    int32 RepairedPaths = 0;
+};
+
+// The genetic algorithm on a FPathGraph, independent of actors and the world
+class MYPROJECT2_API FGeneticSolver : public IPathSolver
+{
+public:
+    explicit FGeneticSolver(const FPathGraph& InGraph);
+
+    // Function to run the genetic algorithm, returns the best path found
+    // The same seed gives the same path regardless of how many worker threads run it
+    virtual FPath Solve(int32 InStartIndex, int32 InEndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested) override;
+
+    // Function to resume from the last solve's islands: paths that cross removed links get detours spliced in,
+    // paths from an old start are led back to it, and evolution carries on from there
+    virtual FPath Replan(int32 InStartIndex, int32 InEndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested) override;
+    virtual EPathSolverType GetType() const override { return EPathSolverType::Genetic; }
+    virtual double GetLastSolveSeconds() const override { return Stats.Seconds; }
+    virtual FGeneticSolverSettings* GetGeneticSettings() override { return &Settings; }
+
+    // Function to calculate the fitness of a path
+    float CalculateFitness(TConstArrayView<int32> Path) const;
+
+    // Function to generate a random path into a buffer, returns its length. A walk that fills the buffer stops there
+    int32 GenerateRandomPath(TArrayView<int32> OutPath, FRandomStream& Random) const;
+
+    // Function to crossover two paths at a point they share into OutChild, returns the child's length.
+    // The child is loop free and only uses links of its parents, a child that fills OutChild stops there
+    int32 Crossover(TConstArrayView<int32> Parent1, TConstArrayView<int32> Parent2, TArrayView<int32> OutChild, FRandomStream& Random) const;
+
+    // Function to mutate a path, keeps its hash and a known fitness (>= 0) up to date
+    void Mutate(TArrayView<int32> Path, FRandomStream& Random, uint64& PathHash, float& PathFitness) const;
+
+    // Function to refine a path with shortcut removal and 2-opt moves, returns its new length
+    int32 LocalSearch(TArrayView<int32> Path, int32 Budget) const;
+
+    static void LogPath(TConstArrayView<int32> Path);
+
+    const FGeneticSolveStats& GetStats() const { return Stats; }
+
+    int32 GetPopulationSize() const
+    {
+        return GENETIC_PATH_FIXED_POPULATION_SIZE > 0 ? GENETIC_PATH_FIXED_POPULATION_SIZE : FMath::Max(2, Settings.PopulationSize);
+    }
+
+    // Points per path slot, a loop-free path never needs more than the graph has
+    int32 GetMaxPathLength() const
+    {
+        return Settings.MaxPathLength > 0 ? FMath::Clamp(Settings.MaxPathLength, 2, Graph.GetNumNodes()) : Graph.GetNumNodes();
+    }
+
+    FGeneticSolverSettings Settings;
+
+    // Bound before Solve to look at the islands as they evolve, the listener must not keep the views
+    FOnGeneticPopulationProgress OnPopulationProgress;
+
+private:
+    // Function to run a cold or warm started solve
+    FPath RunSolve(int32 InStartIndex, int32 InEndIndex, int32 Seed, bool bWarmStart, const std::atomic<bool>& bCancelRequested);
+
+    // Function to tell whether a population from the last solve can be repaired instead of recreated
+    bool CanRepairPopulation(const FPathPopulation& Paths) const;
+
+    // Function to fix every path of a kept population for the current graph, start and end, returns the
+    // number of paths it changed. Scores survive unless the end moved, changed paths are left unscored
+    int32 RepairPopulation(FPathPopulation& Paths, bool bEndChanged, int32 Seed, EParallelForFlags Flags) const;
+
+    // Function to search a bounded detour from a point to any point of Targets with a position of at least
+    // MinPosition, never through Avoid. OutDetour gets the points between, OutPosition the target's position
+    bool FindDetour(int32 From, const TMap<int32, int32>& Targets, int32 MinPosition, const TSet<int32>& Avoid, TArray<int32>& OutDetour, int32& OutPosition) const;
+
+    // Function to select the slots of two parents for crossover with a selection policy from PathSelection.h
+    template <typename TSelection>
+    void SelectParents(const TSelection& Selection, int32& Parent1, int32& Parent2, FRandomStream& Random) const;
+
+    // Functions to run one population of the genetic algorithm, Flags lets islands keep them on one worker
+    void InitializePopulation(FPathPopulation& Paths, int32 Seed, EParallelForFlags Flags) const;
+    int32 EvaluatePopulation(FPathPopulation& Paths, FPathFitnessCache& Cache, EParallelForFlags Flags) const;
+    template <typename TSelection>
+    void BreedPopulation(FPathPopulation& Paths, FPathFitnessCache& Cache, const TSelection& Selection, int32 Seed, int32 Generation, EParallelForFlags Flags) const;
+    void MigrateIslands();
+
+    // Function to run up to NumSteps generations of one island, returns its full evaluations. Stops early
+    // on cancel or past Deadline (0 for none). The selection policy is picked once here so the per-child
+    // loop is compiled for it without dispatch
+    int64 EvolveIsland(int32 Island, int32 Seed, int32 FirstGeneration, int32 NumSteps, double Deadline, EParallelForFlags Flags, const std::atomic<bool>& bCancelRequested);
+    template <typename TSelection>
+    int64 EvolveIsland(TSelection Selection, int32 Island, int32 Seed, int32 FirstGeneration, int32 NumSteps, double Deadline, EParallelForFlags Flags, const std::atomic<bool>& bCancelRequested);
+
+    // Function to hand the best path of an island to OnProgress, if anyone listens
+    void PublishProgress(const FPathPopulation& Paths) const;
+
+    const FPathGraph& Graph;
+    int32 StartIndex = INDEX_NONE;
+    int32 EndIndex = INDEX_NONE;
+    FGeneticSolveStats Stats;
+
+    // Island populations, their fitness caches and the migrant scratch buffer, reused between solves.
+    // With a single island, island 0 is the whole population
+    TArray<FPathPopulation> Islands;
+    TArray<FPathFitnessCache> FitnessCaches;
+    FPathPopulation Migrants;
+};
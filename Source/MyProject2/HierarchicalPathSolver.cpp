@@ -0,0 +1,396 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HierarchicalPathSolver.h"
+#include "MyProject2.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hierarchy Build"), STAT_GeneticPath_HierarchyBuild, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Hierarchical Solve"), STAT_GeneticPath_Hierarchical, STATGROUP_GeneticPath);
+
+static TAutoConsoleVariable<float> CVarGeneticPathClusterSize(
+    TEXT("GeneticPath.ClusterSize"),
+    2000.0f,
+    TEXT("Side of the grid cells the hierarchical solver clusters points into, in world units."));
+
+namespace
+{
+    const auto OpenEntryLess = [](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; };
+}
+
+TSharedRef<const FHierarchicalPathGraph, ESPMode::ThreadSafe> FHierarchicalPathGraphCache::EnsureBuilt(const FPathGraph& Graph, float InClusterSize)
+{
+    // Compared clamped, the way Build stores it, or a size below 1 would rebuild on every query
+    const float ClusterSize = FMath::Max(InClusterSize, 1.0f);
+
+    FScopeLock Lock(&BuildLock);
+    if (!Built.IsValid() || BuiltVersion != Graph.GetVersion() || BuiltClusterSize != ClusterSize)
+    {
+        // Solves still holding the old hierarchy keep reading it until they let go
+        TSharedRef<FHierarchicalPathGraph, ESPMode::ThreadSafe> Hierarchy = MakeShared<FHierarchicalPathGraph, ESPMode::ThreadSafe>();
+        Hierarchy->Build(Graph, ClusterSize);
+        Built = Hierarchy;
+        BuiltVersion = Graph.GetVersion();
+        BuiltClusterSize = ClusterSize;
+    }
+    return Built.ToSharedRef();
+}
+
+void FHierarchicalPathGraph::Build(const FPathGraph& Graph, float InClusterSize)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FHierarchicalPathGraph::Build);
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_HierarchyBuild);
+
+    ClusterSize = FMath::Max(InClusterSize, 1.0f);
+
+    const int32 NumNodes = Graph.GetNumNodes();
+
+    // Clusters are numbered in order of their first point, so the same graph always gives the same ids
+    TMap<FIntVector, int32> CellClusters;
+    NodeCluster.SetNumUninitialized(NumNodes);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        const FIntVector Cell(
+            FMath::FloorToInt(Graph.NodeX[Point] / ClusterSize),
+            FMath::FloorToInt(Graph.NodeY[Point] / ClusterSize),
+            FMath::FloorToInt(Graph.NodeZ[Point] / ClusterSize));
+        NodeCluster[Point] = CellClusters.FindOrAdd(Cell, CellClusters.Num());
+    }
+    const int32 NumClusters = CellClusters.Num();
+
+    // Points of every cluster in CSR form, LocalIndex is a point's position inside its cluster
+    ClusterOffsets.Reset(NumClusters + 1);
+    ClusterOffsets.AddZeroed(NumClusters + 1);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        ClusterOffsets[NodeCluster[Point] + 1]++;
+    }
+    for (int32 Cluster = 0; Cluster < NumClusters; Cluster++)
+    {
+        ClusterOffsets[Cluster + 1] += ClusterOffsets[Cluster];
+    }
+    ClusterNodes.SetNumUninitialized(NumNodes);
+    LocalIndex.SetNumUninitialized(NumNodes);
+    TArray<int32> Cursor(ClusterOffsets.GetData(), NumClusters);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        const int32 Cluster = NodeCluster[Point];
+        LocalIndex[Point] = Cursor[Cluster] - ClusterOffsets[Cluster];
+        ClusterNodes[Cursor[Cluster]++] = Point;
+    }
+
+    // A portal is any point with a link into another cluster
+    PortalNodes.Reset();
+    PortalIndex.Init(INDEX_NONE, NumNodes);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        for (const int32 Neighbor : Graph.GetLinks(Point))
+        {
+            if (NodeCluster[Neighbor] != NodeCluster[Point])
+            {
+                PortalIndex[Point] = PortalNodes.Add(Point);
+                break;
+            }
+        }
+    }
+    const int32 NumPortals = PortalNodes.Num();
+
+    ClusterPortalOffsets.Reset(NumClusters + 1);
+    ClusterPortalOffsets.AddZeroed(NumClusters + 1);
+    for (const int32 Point : PortalNodes)
+    {
+        ClusterPortalOffsets[NodeCluster[Point] + 1]++;
+    }
+    for (int32 Cluster = 0; Cluster < NumClusters; Cluster++)
+    {
+        ClusterPortalOffsets[Cluster + 1] += ClusterPortalOffsets[Cluster];
+    }
+    ClusterPortals.SetNumUninitialized(NumPortals);
+    Cursor = TArray<int32>(ClusterPortalOffsets.GetData(), NumClusters);
+    for (const int32 Point : PortalNodes)
+    {
+        ClusterPortals[Cursor[NodeCluster[Point]]++] = Point;
+    }
+
+    // Portal positions plus two terminal slots, placed by each query
+    TArray<FVector> Locations;
+    Locations.Reserve(NumPortals + 2);
+    for (const int32 Point : PortalNodes)
+    {
+        Locations.Add(Graph.GetNodeLocation(Point));
+    }
+    Locations.AddZeroed(2);
+    AbstractGraph.SetNodeLocations(Locations);
+
+    // Links between clusters are kept as they are
+    TArray<FIntPoint> Links;
+    TArray<float> Costs;
+    for (int32 Portal = 0; Portal < NumPortals; Portal++)
+    {
+        const int32 Point = PortalNodes[Portal];
+        for (int32 k = Graph.LinkOffsets[Point]; k < Graph.LinkEnds[Point]; k++)
+        {
+            const int32 Neighbor = Graph.LinkNeighbors[k];
+            if (NodeCluster[Neighbor] != NodeCluster[Point] && Point < Neighbor)
+            {
+                Links.Emplace(Portal, PortalIndex[Neighbor]);
+                Costs.Add(Graph.LinkLengths[k]);
+            }
+        }
+    }
+
+    // Inside a cluster every reachable portal pair gets the cost of its shortest path, one search per portal
+    TArray<TArray<TPair<FIntPoint, float>>> ClusterLinks;
+    ClusterLinks.SetNum(NumClusters);
+    ParallelFor(NumClusters, [&](int32 Cluster)
+        {
+            FClusterSearch Search;
+            for (const int32 From : GetClusterPortals(Cluster))
+            {
+                SearchCluster(Graph, From, Search);
+                for (const int32 To : GetClusterPortals(Cluster))
+                {
+                    const float Cost = GetClusterCost(Search, To);
+                    if (From < To && Cost < TNumericLimits<float>::Max())
+                    {
+                        ClusterLinks[Cluster].Emplace(FIntPoint(PortalIndex[From], PortalIndex[To]), Cost);
+                    }
+                }
+            }
+        }, EParallelForFlags::Unbalanced);
+
+    for (const TArray<TPair<FIntPoint, float>>& Entries : ClusterLinks)
+    {
+        for (const TPair<FIntPoint, float>& Entry : Entries)
+        {
+            Links.Add(Entry.Key);
+            Costs.Add(Entry.Value);
+        }
+    }
+    AbstractGraph.BuildLinks(Links, Costs);
+
+    // Spare slots for the terminal links a query adds: one per terminal on every portal, and on each
+    // terminal one per portal of the largest cluster plus the direct start to end link
+    int32 MaxClusterPortals = 0;
+    for (int32 Cluster = 0; Cluster < NumClusters; Cluster++)
+    {
+        MaxClusterPortals = FMath::Max(MaxClusterPortals, GetClusterPortals(Cluster).Num());
+    }
+    TArray<int32> NumSpare;
+    NumSpare.Init(2, NumPortals + 2);
+    NumSpare[GetStartTerminal()] = MaxClusterPortals + 1;
+    NumSpare[GetEndTerminal()] = MaxClusterPortals + 1;
+    AbstractGraph.ReserveSpareLinks(NumSpare);
+
+    UE_LOG(LogGeneticPath, Log, TEXT("Hierarchy: %d points in %d clusters, %d portals, %d abstract links."),
+        NumNodes, NumClusters, NumPortals, AbstractGraph.GetNumLinks());
+}
+
+void FHierarchicalPathGraph::SearchCluster(const FPathGraph& Graph, int32 From, FClusterSearch& Search, int32 StopAt) const
+{
+    const int32 Cluster = NodeCluster[From];
+    const int32 ClusterStart = ClusterOffsets[Cluster];
+    const int32 NumLocal = ClusterOffsets[Cluster + 1] - ClusterStart;
+
+    Search.Cluster = Cluster;
+    Search.From = From;
+    Search.Cost.Init(TNumericLimits<float>::Max(), NumLocal);
+    Search.Parent.Init(INDEX_NONE, NumLocal);
+    Search.Closed.Init(false, NumLocal);
+    Search.Open.Reset();
+
+    Search.Cost[LocalIndex[From]] = 0.0f;
+    Search.Open.HeapPush(TPair<float, int32>(0.0f, LocalIndex[From]), OpenEntryLess);
+
+    TPair<float, int32> Entry;
+    while (Search.Open.Num() > 0)
+    {
+        Search.Open.HeapPop(Entry, OpenEntryLess, EAllowShrinking::No);
+        const int32 Local = Entry.Value;
+        if (Search.Closed[Local])
+        {
+            continue;
+        }
+        Search.Closed[Local] = true;
+
+        const int32 Point = ClusterNodes[ClusterStart + Local];
+        if (Point == StopAt)
+        {
+            break;
+        }
+
+        for (int32 k = Graph.LinkOffsets[Point]; k < Graph.LinkEnds[Point]; k++)
+        {
+            const int32 Neighbor = Graph.LinkNeighbors[k];
+            if (NodeCluster[Neighbor] != Cluster)
+            {
+                continue;
+            }
+
+            const int32 NeighborLocal = LocalIndex[Neighbor];
+            const float NeighborCost = Search.Cost[Local] + Graph.LinkLengths[k];
+            if (!Search.Closed[NeighborLocal] && NeighborCost < Search.Cost[NeighborLocal])
+            {
+                Search.Cost[NeighborLocal] = NeighborCost;
+                Search.Parent[NeighborLocal] = Local;
+                Search.Open.HeapPush(TPair<float, int32>(NeighborCost, NeighborLocal), OpenEntryLess);
+            }
+        }
+    }
+}
+
+float FHierarchicalPathGraph::GetClusterCost(const FClusterSearch& Search, int32 Point) const
+{
+    return NodeCluster[Point] == Search.Cluster ? Search.Cost[LocalIndex[Point]] : TNumericLimits<float>::Max();
+}
+
+void FHierarchicalPathGraph::AppendClusterPath(const FClusterSearch& Search, int32 To, TArray<int32>& OutPoints) const
+{
+    const int32 ClusterStart = ClusterOffsets[Search.Cluster];
+    const int32 FirstNew = OutPoints.Num();
+    for (int32 Local = LocalIndex[To]; Local != INDEX_NONE && ClusterNodes[ClusterStart + Local] != Search.From; Local = Search.Parent[Local])
+    {
+        OutPoints.Add(ClusterNodes[ClusterStart + Local]);
+    }
+    Algo::Reverse(OutPoints.GetData() + FirstNew, OutPoints.Num() - FirstNew);
+}
+
+SIZE_T FHierarchicalPathGraph::GetAllocatedSize() const
+{
+    return NodeCluster.GetAllocatedSize() + LocalIndex.GetAllocatedSize() + ClusterOffsets.GetAllocatedSize() + ClusterNodes.GetAllocatedSize()
+        + PortalNodes.GetAllocatedSize() + PortalIndex.GetAllocatedSize() + ClusterPortalOffsets.GetAllocatedSize() + ClusterPortals.GetAllocatedSize()
+        + AbstractGraph.GetAllocatedSize();
+}
+
+FHierarchicalSolver::FHierarchicalSolver(const FPathGraph& InGraph)
+    : Graph(InGraph)
+    , Hierarchy(MakeShared<FHierarchicalPathGraphCache, ESPMode::ThreadSafe>())
+{
+}
+
+FPath FHierarchicalSolver::Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FHierarchicalSolver::Solve);
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_Hierarchical);
+
+    const double SolveStartTime = FPlatformTime::Seconds();
+    FPath Path;
+    if (!Graph.IsValidNode(StartIndex) || !Graph.IsValidNode(EndIndex))
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Start or End point is not in the graph! StartIndex: %d, EndIndex: %d"), StartIndex, EndIndex);
+        return Path;
+    }
+
+    // Held for the whole solve, a rebuild by another query publishes a new hierarchy instead of changing this one
+    const TSharedRef<const FHierarchicalPathGraph, ESPMode::ThreadSafe> ClustersRef = Hierarchy->EnsureBuilt(Graph, CVarGeneticPathClusterSize.GetValueOnAnyThread());
+    const FHierarchicalPathGraph& Clusters = *ClustersRef;
+
+    // The abstract graph is copied once per build, later queries only unlink the previous terminals
+    const int32 StartTerminal = Clusters.GetStartTerminal();
+    const int32 EndTerminal = Clusters.GetEndTerminal();
+    if (QueryHierarchy.Get() != &Clusters)
+    {
+        QueryGraph = Clusters.GetAbstractGraph();
+        QueryHierarchy = ClustersRef;
+    }
+    else
+    {
+        QueryGraph.UnlinkPoint(StartTerminal);
+        QueryGraph.UnlinkPoint(EndTerminal);
+    }
+
+    // Link the terminals to the portals their point reaches inside its cluster, and to each other
+    // when start and end share a cluster. The links go into the rows' spare slots, nothing else moves
+    QueryGraph.NodeX[StartTerminal] = Graph.NodeX[StartIndex];
+    QueryGraph.NodeY[StartTerminal] = Graph.NodeY[StartIndex];
+    QueryGraph.NodeZ[StartTerminal] = Graph.NodeZ[StartIndex];
+    QueryGraph.NodeX[EndTerminal] = Graph.NodeX[EndIndex];
+    QueryGraph.NodeY[EndTerminal] = Graph.NodeY[EndIndex];
+    QueryGraph.NodeZ[EndTerminal] = Graph.NodeZ[EndIndex];
+
+    auto LinkTerminal = [&](int32 Terminal, int32 Point, FHierarchicalPathGraph::FClusterSearch& Search)
+        {
+            Clusters.SearchCluster(Graph, Point, Search);
+            for (const int32 Portal : Clusters.GetClusterPortals(Clusters.GetCluster(Point)))
+            {
+                const float Cost = Clusters.GetClusterCost(Search, Portal);
+                if (Cost < TNumericLimits<float>::Max())
+                {
+                    QueryGraph.AddLinkInPlace(Terminal, Clusters.GetPortalIndex(Portal), Cost);
+                }
+            }
+        };
+    LinkTerminal(StartTerminal, StartIndex, StartSearch);
+    LinkTerminal(EndTerminal, EndIndex, EndSearch);
+    const float DirectCost = Clusters.GetClusterCost(StartSearch, EndIndex);
+    if (StartIndex != EndIndex && DirectCost < TNumericLimits<float>::Max())
+    {
+        QueryGraph.AddLinkInPlace(StartTerminal, EndTerminal, DirectCost);
+    }
+
+    // Auto means A* or the GA by the abstract graph's size, never another level of hierarchy
+    EPathSolverType ResolvedInnerType = ResolvePathSolverType(InnerType == EPathSolverType::Hierarchical ? EPathSolverType::Auto : InnerType, QueryGraph);
+    if (ResolvedInnerType == EPathSolverType::Hierarchical)
+    {
+        ResolvedInnerType = EPathSolverType::Genetic;
+    }
+    if (!InnerSolver || InnerSolver->GetType() != ResolvedInnerType)
+    {
+        InnerSolver = MakePathSolver(ResolvedInnerType, QueryGraph);
+    }
+    if (FGeneticSolverSettings* InnerSettings = InnerSolver->GetGeneticSettings())
+    {
+        *InnerSettings = GeneticSettings;
+    }
+
+    const FPath AbstractPath = InnerSolver->Solve(StartTerminal, EndTerminal, Seed, bCancelRequested);
+    if (AbstractPath.PathPoints.Num() == 0 || bCancelRequested.load(std::memory_order_relaxed))
+    {
+        LastSolveSeconds = FPlatformTime::Seconds() - SolveStartTime;
+        return Path;
+    }
+
+    // Refine leg by leg: links between clusters are taken as they are, legs inside a cluster are searched again
+    Path.PathPoints.Add(StartIndex);
+    for (int32 i = 1; i < AbstractPath.PathPoints.Num(); i++)
+    {
+        const int32 Abstract = AbstractPath.PathPoints[i];
+        const int32 From = Path.PathPoints.Last();
+        const int32 To = Abstract == StartTerminal ? StartIndex : Abstract == EndTerminal ? EndIndex : Clusters.GetPortalNode(Abstract);
+        if (From == To)
+        {
+            continue;
+        }
+
+        if (Clusters.GetCluster(From) != Clusters.GetCluster(To))
+        {
+            // The GA can hand back a repaired path with a gap, keep the part that is on the graph
+            if (!Graph.IsValidLink(From, To))
+            {
+                break;
+            }
+            Path.PathPoints.Add(To);
+            continue;
+        }
+
+        Clusters.SearchCluster(Graph, From, LegSearch, To);
+        if (Clusters.GetClusterCost(LegSearch, To) == TNumericLimits<float>::Max())
+        {
+            break;
+        }
+        Clusters.AppendClusterPath(LegSearch, To, Path.PathPoints);
+    }
+
+    // Scored like a GA path, a refined path that reached its end scores 1 / length
+    const float PathLength = Graph.GetPathCost(Path.PathPoints);
+    const float Remaining = Graph.GetSegmentLength(Path.PathPoints.Last(), EndIndex);
+    Path.Fitness = PathLength + Remaining > 0.0f ? 1.0f / (PathLength + Remaining) : 0.0f;
+
+    UE_LOG(LogGeneticPath, Verbose, TEXT("Hierarchical %d -> %d: %d abstract points refined to %d."), StartIndex, EndIndex, AbstractPath.PathPoints.Num(), Path.PathPoints.Num());
+    LastSolveSeconds = FPlatformTime::Seconds() - SolveStartTime;
+    return Path;
+}
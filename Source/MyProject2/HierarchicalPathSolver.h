@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GeneticSolver.h"
+#include "PathGraph.h"
+#include "PathSolver.h"
+
+// Clusters of a FPathGraph on a uniform grid, with the points that link across clusters as portals.
+// The abstract graph links portals directly across clusters and, inside a cluster, with the cost of
+// the shortest path between them, so a search there only ever touches portals
+class MYPROJECT2_API FHierarchicalPathGraph
+{
+public:
+    // Dijkstra confined to one cluster, indexed by the points' position inside their cluster
+    struct FClusterSearch
+    {
+        int32 Cluster = INDEX_NONE;
+        int32 From = INDEX_NONE;
+        TArray<float> Cost;
+        TArray<int32> Parent;
+        TArray<bool> Closed;
+        TArray<TPair<float, int32>> Open;
+    };
+
+    // Function to build the clusters and the abstract graph, cluster size is at least 1
+    void Build(const FPathGraph& Graph, float InClusterSize);
+
+    // Portals first, then the two terminal slots a query links its start and end into
+    const FPathGraph& GetAbstractGraph() const { return AbstractGraph; }
+    int32 GetStartTerminal() const { return PortalNodes.Num(); }
+    int32 GetEndTerminal() const { return PortalNodes.Num() + 1; }
+
+    int32 GetNumClusters() const { return ClusterOffsets.Num() - 1; }
+    int32 GetCluster(int32 Point) const { return NodeCluster[Point]; }
+    TConstArrayView<int32> GetClusterPortals(int32 Cluster) const
+    {
+        return TConstArrayView<int32>(ClusterPortals.GetData() + ClusterPortalOffsets[Cluster], ClusterPortalOffsets[Cluster + 1] - ClusterPortalOffsets[Cluster]);
+    }
+
+    // Abstract index of a portal point and back
+    int32 GetPortalIndex(int32 Point) const { return PortalIndex[Point]; }
+    int32 GetPortalNode(int32 Portal) const { return PortalNodes[Portal]; }
+
+    // Function to run Dijkstra from a point over the links inside its cluster, stops early once StopAt is closed
+    void SearchCluster(const FPathGraph& Graph, int32 From, FClusterSearch& Search, int32 StopAt = INDEX_NONE) const;
+
+    // Cost from the search's start to a point of the same cluster, max float if it wasn't reached
+    float GetClusterCost(const FClusterSearch& Search, int32 Point) const;
+
+    // Function to append the points after the search's start up to To
+    void AppendClusterPath(const FClusterSearch& Search, int32 To, TArray<int32>& OutPoints) const;
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    float ClusterSize = 0.0f;
+
+    // Cluster of every point and the points of every cluster in CSR form
+    TArray<int32> NodeCluster;
+    TArray<int32> LocalIndex;
+    TArray<int32> ClusterOffsets;
+    TArray<int32> ClusterNodes;
+
+    // Portals by abstract index, by point, and by cluster
+    TArray<int32> PortalNodes;
+    TArray<int32> PortalIndex;
+    TArray<int32> ClusterPortalOffsets;
+    TArray<int32> ClusterPortals;
+
+    FPathGraph AbstractGraph;
+};
+
+// Latest hierarchy of one graph, shared by the solvers of that graph. A rebuild publishes a new
+// hierarchy and never changes one a running solve still holds, so reading it needs no lock
+class MYPROJECT2_API FHierarchicalPathGraphCache
+{
+public:
+    // Function to get the hierarchy for this graph version and cluster size, built unless it already exists.
+    // Safe to call from several solves at once, the first one builds
+    TSharedRef<const FHierarchicalPathGraph, ESPMode::ThreadSafe> EnsureBuilt(const FPathGraph& Graph, float InClusterSize);
+
+private:
+    FCriticalSection BuildLock;
+    TSharedPtr<const FHierarchicalPathGraph, ESPMode::ThreadSafe> Built;
+    uint32 BuiltVersion = 0;
+    float BuiltClusterSize = 0.0f;
+};
+
+// Searches the abstract portal graph with an inner solver, then refines every leg inside its cluster.
+// Solve cost follows the number of portals instead of the number of points
+class MYPROJECT2_API FHierarchicalSolver : public IPathSolver
+{
+public:
+    explicit FHierarchicalSolver(const FPathGraph& InGraph);
+
+    virtual FPath Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested) override;
+    virtual EPathSolverType GetType() const override { return EPathSolverType::Hierarchical; }
+    virtual double GetLastSolveSeconds() const override { return LastSolveSeconds; }
+    virtual FGeneticSolverSettings* GetGeneticSettings() override { return &GeneticSettings; }
+
+    // Function to share one hierarchy between the solvers of the same graph, otherwise each builds its own
+    void SetHierarchy(TSharedPtr<FHierarchicalPathGraphCache, ESPMode::ThreadSafe> InHierarchy) { Hierarchy = MoveTemp(InHierarchy); }
+
+    // Strategy for the abstract graph, Auto picks A* or the GA by its size
+    EPathSolverType InnerType = EPathSolverType::Auto;
+
+    // Settings for the inner GA, when it is one
+    FGeneticSolverSettings GeneticSettings;
+
+private:
+    const FPathGraph& Graph;
+    TSharedPtr<FHierarchicalPathGraphCache, ESPMode::ThreadSafe> Hierarchy;
+
+    // Abstract graph with this query's terminals linked in, and the solver running on it.
+    // Copied again only when the cache hands out a new hierarchy, which is kept alive until then
+    FPathGraph QueryGraph;
+    TSharedPtr<const FHierarchicalPathGraph, ESPMode::ThreadSafe> QueryHierarchy;
+    TUniquePtr<IPathSolver> InnerSolver;
+
+    FHierarchicalPathGraph::FClusterSearch StartSearch;
+    FHierarchicalPathGraph::FClusterSearch EndSearch;
+    FHierarchicalPathGraph::FClusterSearch LegSearch;
+    double LastSolveSeconds = 0.0;
+};
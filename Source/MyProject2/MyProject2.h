@@ -4,3 +4,15 @@
 
 #include "CoreMinimal.h"
 
+// Test and Shipping builds compile out everything below Log, which strips the solver's per-operation messages
+#if UE_BUILD_SHIPPING || UE_BUILD_TEST
+DECLARE_LOG_CATEGORY_EXTERN(LogGeneticPath, Log, Log);
+#else
+DECLARE_LOG_CATEGORY_EXTERN(LogGeneticPath, Log, All);
+#endif
+
+DECLARE_STATS_GROUP(TEXT("GeneticPath"), STATGROUP_GeneticPath, STATCAT_Advanced);
+
+// Object channel of path barriers, the "Barrier" entry in DefaultEngine.ini's collision settings.
+// Link traces query only this object type, so floors and props never end a trace early
+#define ECC_Barrier ECC_GameTraceChannel2
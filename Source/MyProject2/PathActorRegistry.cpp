@@ -0,0 +1,195 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathActorRegistry.h"
+#include "MyProject2.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+const FName UPathActorRegistry::PointTag(TEXT("Point"));
+const FName UPathActorRegistry::BarrierTag(TEXT("Barrier"));
+const FName UPathActorRegistry::StartPointTag(TEXT("StartPoint"));
+const FName UPathActorRegistry::EndPointTag(TEXT("EndPoint"));
+
+void UPathActorRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    for (const FName Tag : { PointTag, BarrierTag, StartPointTag, EndPointTag })
+    {
+        TagSets.Add(Tag);
+    }
+
+    UWorld* World = GetWorld();
+    ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UPathActorRegistry::RegisterActor));
+    ActorDestroyedHandle = World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UPathActorRegistry::UnregisterActor));
+    LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UPathActorRegistry::OnLevelAdded);
+    LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UPathActorRegistry::OnLevelRemoved);
+}
+
+void UPathActorRegistry::Deinitialize()
+{
+    UWorld* World = GetWorld();
+    World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+    World->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+    FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+    FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+    TagSets.Reset();
+
+    Super::Deinitialize();
+}
+
+void UPathActorRegistry::OnWorldBeginPlay(UWorld& InWorld)
+{
+    Super::OnWorldBeginPlay(InWorld);
+
+    // Runs before any actor's BeginPlay, so the path finder already sees the whole level
+    RegisterLevelActors();
+}
+
+void UPathActorRegistry::RegisterActor(AActor* Actor)
+{
+    if (!Actor)
+    {
+        return;
+    }
+
+    for (const FName& Tag : Actor->Tags)
+    {
+        FTagSet* Set = TagSets.Find(Tag);
+        if (!Set || Set->SlotIndex.Contains(Actor))
+        {
+            continue;
+        }
+
+        const int32 Index = Set->FreeSlots.Num() > 0 ? Set->FreeSlots.Pop(EAllowShrinking::No) : Set->Slots.AddDefaulted();
+        Set->Slots[Index] = Actor;
+        Set->SlotIndex.Add(Actor, Index);
+        OnActorRegistered.Broadcast(Tag, Actor);
+    }
+}
+
+void UPathActorRegistry::UnregisterActor(AActor* Actor)
+{
+    if (!Actor)
+    {
+        return;
+    }
+
+    // The actor's tags may have changed since it registered, so look in every set
+    for (TPair<FName, FTagSet>& Entry : TagSets)
+    {
+        FTagSet& Set = Entry.Value;
+        int32 Index = INDEX_NONE;
+        if (Set.SlotIndex.RemoveAndCopyValue(Actor, Index))
+        {
+            Set.Slots[Index].Reset();
+            Set.FreeSlots.Add(Index);
+            OnActorUnregistered.Broadcast(Entry.Key, Actor);
+        }
+    }
+}
+
+void UPathActorRegistry::RegisterLevelActors()
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(UPathActorRegistry::RegisterLevelActors);
+
+    for (TPair<FName, FTagSet>& Entry : TagSets)
+    {
+        Entry.Value = FTagSet();
+    }
+
+    for (const ULevel* Level : GetWorld()->GetLevels())
+    {
+        RegisterLevel(Level);
+    }
+
+    UE_LOG(LogGeneticPath, Log, TEXT("Registered %d points and %d barriers."), GetNumActors(PointTag), GetNumActors(BarrierTag));
+}
+
+void UPathActorRegistry::RegisterLevel(const ULevel* Level)
+{
+    if (!Level)
+    {
+        return;
+    }
+
+    for (AActor* Actor : Level->Actors)
+    {
+        if (IsValid(Actor))
+        {
+            RegisterActor(Actor);
+        }
+    }
+}
+
+void UPathActorRegistry::OnLevelAdded(ULevel* Level, UWorld* InWorld)
+{
+    if (InWorld == GetWorld())
+    {
+        RegisterLevel(Level);
+    }
+}
+
+void UPathActorRegistry::OnLevelRemoved(ULevel* Level, UWorld* InWorld)
+{
+    // A null level means every level of the world is going away
+    if (InWorld != GetWorld() || !Level)
+    {
+        return;
+    }
+
+    for (AActor* Actor : Level->Actors)
+    {
+        UnregisterActor(Actor);
+    }
+}
+
+TConstArrayView<TWeakObjectPtr<AActor>> UPathActorRegistry::GetActorSlots(FName Tag) const
+{
+    const FTagSet* Set = TagSets.Find(Tag);
+    return Set ? TConstArrayView<TWeakObjectPtr<AActor>>(Set->Slots) : TConstArrayView<TWeakObjectPtr<AActor>>();
+}
+
+TArray<AActor*> UPathActorRegistry::GetActors(FName Tag) const
+{
+    TArray<AActor*> Actors;
+    if (const FTagSet* Set = TagSets.Find(Tag))
+    {
+        Actors.Reserve(Set->SlotIndex.Num());
+        for (const TWeakObjectPtr<AActor>& Slot : Set->Slots)
+        {
+            if (AActor* Actor = Slot.Get())
+            {
+                Actors.Add(Actor);
+            }
+        }
+    }
+    return Actors;
+}
+
+int32 UPathActorRegistry::GetNumActors(FName Tag) const
+{
+    const FTagSet* Set = TagSets.Find(Tag);
+    return Set ? Set->SlotIndex.Num() : 0;
+}
+
+int32 UPathActorRegistry::GetActorIndex(FName Tag, const AActor* Actor) const
+{
+    const FTagSet* Set = TagSets.Find(Tag);
+    const int32* Index = Set ? Set->SlotIndex.Find(Actor) : nullptr;
+    return Index ? *Index : INDEX_NONE;
+}
+
+AActor* UPathActorRegistry::GetFirstActor(FName Tag) const
+{
+    for (const TWeakObjectPtr<AActor>& Slot : GetActorSlots(Tag))
+    {
+        if (AActor* Actor = Slot.Get())
+        {
+            return Actor;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "PathActorRegistry.generated.h"
+
+// Fired when an actor enters or leaves the set of one of the tracked tags
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPathActorRegistryChanged, FName /*Tag*/, AActor* /*Actor*/);
+
+// Point, barrier, start and end actors of a world, indexed by tag so the path finder never has to
+// walk every actor in the world. Actors placed in a level are registered when the world begins play
+// or their level streams in, spawned ones when they spawn, and destroyed ones leave on their own.
+// Blueprints may also call RegisterActor/UnregisterActor from BeginPlay/EndPlay, both are idempotent.
+// An actor keeps its index in a tag until it unregisters, freed indices are reused so the sets stay dense
+UCLASS()
+class MYPROJECT2_API UPathActorRegistry : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // Tags the registry tracks, any other tag is ignored
+    static const FName PointTag;
+    static const FName BarrierTag;
+    static const FName StartPointTag;
+    static const FName EndPointTag;
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+    virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+    // Function to add an actor to the set of every tracked tag it carries
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    void RegisterActor(AActor* Actor);
+
+    // Function to remove an actor from every set it is in
+    UFUNCTION(BlueprintCallable, Category = "Pathfinding")
+    void UnregisterActor(AActor* Actor);
+
+    // Function to drop everything and register the tagged actors of the loaded levels again.
+    // Editor worlds never begin play, the bake calls this before reading the sets
+    void RegisterLevelActors();
+
+    // Every index of a tag, an unregistered index holds an empty pointer until it is reused
+    TConstArrayView<TWeakObjectPtr<AActor>> GetActorSlots(FName Tag) const;
+
+    // Registered actors of a tag in index order, without the empty indices
+    TArray<AActor*> GetActors(FName Tag) const;
+
+    int32 GetNumActors(FName Tag) const;
+
+    // Index of an actor in a tag's set, INDEX_NONE if it isn't registered there
+    int32 GetActorIndex(FName Tag, const AActor* Actor) const;
+
+    // Registered actor with the lowest index of a tag, for tags that mark a single actor
+    AActor* GetFirstActor(FName Tag) const;
+
+    FOnPathActorRegistryChanged OnActorRegistered;
+    FOnPathActorRegistryChanged OnActorUnregistered;
+
+private:
+    struct FTagSet
+    {
+        TArray<TWeakObjectPtr<AActor>> Slots;
+        TArray<int32> FreeSlots;
+        TMap<TObjectKey<AActor>, int32> SlotIndex;
+    };
+
+    void RegisterLevel(const ULevel* Level);
+    void OnLevelAdded(ULevel* Level, UWorld* InWorld);
+    void OnLevelRemoved(ULevel* Level, UWorld* InWorld);
+
+    TMap<FName, FTagSet> TagSets;
+
+    FDelegateHandle ActorSpawnedHandle;
+    FDelegateHandle ActorDestroyedHandle;
+    FDelegateHandle LevelAddedHandle;
+    FDelegateHandle LevelRemovedHandle;
+};
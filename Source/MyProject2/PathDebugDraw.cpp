@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathDebugDraw.h"
+#include "PathGraph.h"
+#include "PathPopulation.h"
+#include "Algo/BinarySearch.h"
+#include "Components/LineBatchComponent.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace
+{
+    // Lifetime 0 keeps a line until its batch is cleared
+    constexpr float PersistentLifeTime = 0.0f;
+
+    // Slot of the link from Low to High in the lower point's row, INDEX_NONE if they aren't linked
+    int32 FindLinkSlot(const FPathGraph& Graph, int32 Low, int32 High)
+    {
+        const int32 Position = Algo::BinarySearch(Graph.GetLinks(Low), High);
+        return Position != INDEX_NONE ? Graph.LinkOffsets[Low] + Position : INDEX_NONE;
+    }
+}
+
+void FPathDebugDraw::DrawGraph(ULineBatchComponent& Lines, const FPathGraph& Graph)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FPathDebugDraw::DrawGraph);
+
+    TArray<FBatchedLine> Batch;
+    Batch.Reserve(Graph.GetNumLinks());
+    for (int32 Point = 0; Point < Graph.GetNumNodes(); Point++)
+    {
+        for (int32 Neighbor : Graph.GetLinks(Point))
+        {
+            // Every link is stored in both rows, draw it once
+            if (Neighbor > Point)
+            {
+                Batch.Emplace(Graph.GetNodeLocation(Point), Graph.GetNodeLocation(Neighbor), FLinearColor(0.2f, 0.2f, 0.2f), PersistentLifeTime, 0.0f, SDPG_World, GraphBatch);
+            }
+        }
+    }
+
+    Lines.ClearBatch(GraphBatch);
+    Lines.DrawLines(Batch);
+}
+
+void FPathDebugDraw::DrawPath(ULineBatchComponent& Lines, const FPathGraph& Graph, TConstArrayView<int32> Points)
+{
+    TArray<FBatchedLine> Batch;
+    Batch.Reserve(FMath::Max(Points.Num() - 1, 0));
+    for (int32 i = 0; i + 1 < Points.Num(); i++)
+    {
+        if (Graph.IsValidNode(Points[i]) && Graph.IsValidNode(Points[i + 1]))
+        {
+            Batch.Emplace(Graph.GetNodeLocation(Points[i]), Graph.GetNodeLocation(Points[i + 1]), FLinearColor::Green, PersistentLifeTime, 4.0f, SDPG_Foreground, PathBatch);
+        }
+    }
+
+    Lines.ClearBatch(PathBatch);
+    Lines.DrawLines(Batch);
+}
+
+void FPathDebugDraw::CountEdgeUsage(const FPathGraph& Graph, TConstArrayView<FPathPopulation> Islands, TArray<int32>& OutUsage)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FPathDebugDraw::CountEdgeUsage);
+
+    OutUsage.Reset();
+    OutUsage.SetNumZeroed(Graph.LinkNeighbors.Num());
+    for (const FPathPopulation& Paths : Islands)
+    {
+        for (int32 Slot = 0; Slot < Paths.Num(); Slot++)
+        {
+            const TConstArrayView<int32> Points = Paths.GetPath(Slot);
+            for (int32 i = 0; i + 1 < Points.Num(); i++)
+            {
+                const int32 LinkSlot = FindLinkSlot(Graph, FMath::Min(Points[i], Points[i + 1]), FMath::Max(Points[i], Points[i + 1]));
+                if (LinkSlot != INDEX_NONE)
+                {
+                    OutUsage[LinkSlot]++;
+                }
+            }
+        }
+    }
+}
+
+void FPathDebugDraw::DrawEdgeUsage(ULineBatchComponent& Lines, const FPathGraph& Graph, TConstArrayView<int32> Usage)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FPathDebugDraw::DrawEdgeUsage);
+
+    Lines.ClearBatch(EdgeUsageBatch);
+
+    // Usage from an older graph doesn't line up with the rows anymore
+    if (Usage.Num() != Graph.LinkNeighbors.Num())
+    {
+        return;
+    }
+
+    int32 MaxUsage = 0;
+    for (int32 Count : Usage)
+    {
+        MaxUsage = FMath::Max(MaxUsage, Count);
+    }
+    if (MaxUsage == 0)
+    {
+        return;
+    }
+
+    TArray<FBatchedLine> Batch;
+    for (int32 Point = 0; Point < Graph.GetNumNodes(); Point++)
+    {
+        for (int32 k = Graph.LinkOffsets[Point]; k < Graph.LinkEnds[Point]; k++)
+        {
+            if (Usage[k] == 0)
+            {
+                continue;
+            }
+
+            const float Heat = static_cast<float>(Usage[k]) / MaxUsage;
+            const FLinearColor Color = FLinearColor::LerpUsingHSV(FLinearColor::Blue, FLinearColor::Red, Heat);
+            Batch.Emplace(Graph.GetNodeLocation(Point), Graph.GetNodeLocation(Graph.LinkNeighbors[k]), Color, PersistentLifeTime, 1.0f + 3.0f * Heat, SDPG_World, EdgeUsageBatch);
+        }
+    }
+
+    Lines.DrawLines(Batch);
+}
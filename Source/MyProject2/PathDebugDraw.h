@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPathGraph;
+class FPathPopulation;
+class ULineBatchComponent;
+
+// Debug drawing of the link graph, a path and the population's link usage into one persistent
+// line batch. Each layer is its own batch, so redrawing one never touches the others and the
+// cost of a frame doesn't grow with the number of segments drawn
+struct MYPROJECT2_API FPathDebugDraw
+{
+    // Line batch ids of the layers
+    static constexpr uint32 GraphBatch = 0x47500001;
+    static constexpr uint32 PathBatch = 0x47500002;
+    static constexpr uint32 EdgeUsageBatch = 0x47500003;
+
+    // Function to replace the graph layer with every link
+    static void DrawGraph(ULineBatchComponent& Lines, const FPathGraph& Graph);
+
+    // Function to replace the path layer, an empty path just clears it
+    static void DrawPath(ULineBatchComponent& Lines, const FPathGraph& Graph, TConstArrayView<int32> Points);
+
+    // Function to count the paths crossing each link. OutUsage is aligned with Graph.LinkNeighbors and
+    // only the slot in the lower point's row is counted, segments that are not links are skipped
+    static void CountEdgeUsage(const FPathGraph& Graph, TConstArrayView<FPathPopulation> Islands, TArray<int32>& OutUsage);
+
+    // Function to replace the usage layer with the used links, from cold and thin to hot and thick
+    static void DrawEdgeUsage(ULineBatchComponent& Lines, const FPathGraph& Graph, TConstArrayView<int32> Usage);
+};
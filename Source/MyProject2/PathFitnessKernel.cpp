@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathFitnessKernel.h"
+#include "MyProject2.h"
+#include "GeneticSolver.h"
+#include "PathGraph.h"
+#include "PathPopulation.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+
+#if !UE_BUILD_SHIPPING
+static TAutoConsoleVariable<bool> CVarGeneticPathVerifyVectorizedFitness(
+    TEXT("GeneticPath.VerifyVectorizedFitness"),
+    false,
+    TEXT("Recompute every vectorized fitness with the scalar loop and ensure they agree within a relative tolerance."));
+#endif
+
+namespace
+{
+    // Vector lanes sum in a different order than the scalar loop, so results differ by rounding only
+    constexpr float VerifyRelativeTolerance = 1e-4f;
+
+    FORCEINLINE VectorRegister4Float GatherCoordinates(const float* Coordinates, int32 A, int32 B, int32 C, int32 D)
+    {
+        return MakeVectorRegisterFloat(Coordinates[A], Coordinates[B], Coordinates[C], Coordinates[D]);
+    }
+
+    FORCEINLINE VectorRegister4Float VectorLength(const VectorRegister4Float& DX, const VectorRegister4Float& DY, const VectorRegister4Float& DZ)
+    {
+        return VectorSqrt(VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX))));
+    }
+
+    float ScalarFitness(const FPathGraph& Graph, int32 EndIndex, TConstArrayView<int32> Points)
+    {
+        return Points.Num() < 2 ? 0.0f : 1.0f / (Graph.GetPathCost(Points) + Graph.GetSegmentLength(Points.Last(), EndIndex));
+    }
+}
+
+float FPathFitnessKernel::SumSegmentLengths(const FPathGraph& Graph, TConstArrayView<int32> Points)
+{
+    const int32 NumSegments = Points.Num() - 1;
+    if (NumSegments <= 0)
+    {
+        return 0.0f;
+    }
+
+    const float* X = Graph.NodeX.GetData();
+    const float* Y = Graph.NodeY.GetData();
+    const float* Z = Graph.NodeZ.GetData();
+    const int32* P = Points.GetData();
+
+    VectorRegister4Float Sum = VectorZeroFloat();
+    int32 i = 0;
+    for (; i + 4 <= NumSegments; i += 4)
+    {
+        const VectorRegister4Float DX = VectorSubtract(GatherCoordinates(X, P[i + 1], P[i + 2], P[i + 3], P[i + 4]), GatherCoordinates(X, P[i], P[i + 1], P[i + 2], P[i + 3]));
+        const VectorRegister4Float DY = VectorSubtract(GatherCoordinates(Y, P[i + 1], P[i + 2], P[i + 3], P[i + 4]), GatherCoordinates(Y, P[i], P[i + 1], P[i + 2], P[i + 3]));
+        const VectorRegister4Float DZ = VectorSubtract(GatherCoordinates(Z, P[i + 1], P[i + 2], P[i + 3], P[i + 4]), GatherCoordinates(Z, P[i], P[i + 1], P[i + 2], P[i + 3]));
+        Sum = VectorAdd(Sum, VectorLength(DX, DY, DZ));
+    }
+
+    alignas(16) float Lanes[4];
+    VectorStoreAligned(Sum, Lanes);
+    float Length = (Lanes[0] + Lanes[1]) + (Lanes[2] + Lanes[3]);
+
+    // Up to three segments left over
+    for (; i < NumSegments; i++)
+    {
+        Length += Graph.GetSegmentLength(P[i], P[i + 1]);
+    }
+    return Length;
+}
+
+void FPathFitnessKernel::ScorePaths(const FPathGraph& Graph, int32 EndIndex, FPathPopulation& Paths, TConstArrayView<int32> Slots, bool bVectorized)
+{
+    if (!bVectorized)
+    {
+        for (const int32 Slot : Slots)
+        {
+            Paths.SetFitness(Slot, ScalarFitness(Graph, EndIndex, Paths.GetPath(Slot)));
+        }
+        return;
+    }
+
+    const VectorRegister4Float EndX = VectorSetFloat1(Graph.NodeX[EndIndex]);
+    const VectorRegister4Float EndY = VectorSetFloat1(Graph.NodeY[EndIndex]);
+    const VectorRegister4Float EndZ = VectorSetFloat1(Graph.NodeZ[EndIndex]);
+
+    for (int32 First = 0; First < Slots.Num(); First += 4)
+    {
+        // Lanes past the end of the batch score a dummy path ending at EndIndex and are not written back
+        const int32 NumLanes = FMath::Min(4, Slots.Num() - First);
+        alignas(16) float Lengths[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        int32 LastPoints[4] = { EndIndex, EndIndex, EndIndex, EndIndex };
+        for (int32 Lane = 0; Lane < NumLanes; Lane++)
+        {
+            const TConstArrayView<int32> Points = Paths.GetPath(Slots[First + Lane]);
+            if (Points.Num() > 0)
+            {
+                // Link costs are looked up per step, only straight lengths can be computed four at a time
+                Lengths[Lane] = Graph.HasLinkCosts() ? Graph.GetPathCost(Points) : SumSegmentLengths(Graph, Points);
+                LastPoints[Lane] = Points.Last();
+            }
+        }
+
+        // Distance to the goal for all four paths in one step
+        const VectorRegister4Float DX = VectorSubtract(EndX, GatherCoordinates(Graph.NodeX.GetData(), LastPoints[0], LastPoints[1], LastPoints[2], LastPoints[3]));
+        const VectorRegister4Float DY = VectorSubtract(EndY, GatherCoordinates(Graph.NodeY.GetData(), LastPoints[0], LastPoints[1], LastPoints[2], LastPoints[3]));
+        const VectorRegister4Float DZ = VectorSubtract(EndZ, GatherCoordinates(Graph.NodeZ.GetData(), LastPoints[0], LastPoints[1], LastPoints[2], LastPoints[3]));
+        alignas(16) float Totals[4];
+        VectorStoreAligned(VectorAdd(VectorLoadAligned(Lengths), VectorLength(DX, DY, DZ)), Totals);
+
+        for (int32 Lane = 0; Lane < NumLanes; Lane++)
+        {
+            const int32 Slot = Slots[First + Lane];
+            const float Fitness = Paths.GetPath(Slot).Num() < 2 ? 0.0f : 1.0f / Totals[Lane];
+            Paths.SetFitness(Slot, Fitness);
+
+#if !UE_BUILD_SHIPPING
+            if (CVarGeneticPathVerifyVectorizedFitness.GetValueOnAnyThread())
+            {
+                const float ScalarResult = ScalarFitness(Graph, EndIndex, Paths.GetPath(Slot));
+                ensureMsgf(FMath::IsNearlyEqual(Fitness, ScalarResult, FMath::Abs(ScalarResult) * VerifyRelativeTolerance),
+                    TEXT("Vectorized fitness %f differs from scalar %f for path %s"), Fitness, ScalarResult, *FPath::ToString(Paths.GetPath(Slot)));
+            }
+#endif
+        }
+    }
+}
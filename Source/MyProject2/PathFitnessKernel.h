@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPathGraph;
+class FPathPopulation;
+
+// Batched fitness for the GA. Segment lengths are computed four at a time with VectorRegister
+// (SSE, NEON, or UE's scalar fallback), gathering coordinates from the graph's flat X/Y/Z arrays
+struct MYPROJECT2_API FPathFitnessKernel
+{
+    // Function to sum the straight segments along a path, four segments per vector step
+    static float SumSegmentLengths(const FPathGraph& Graph, TConstArrayView<int32> Points);
+
+    // Function to score a batch of population slots like FGeneticSolver::CalculateFitness,
+    // 1 / (path cost + distance from the last point to EndIndex), four paths per vector step.
+    // bVectorized false runs the plain scalar loops, for comparison
+    static void ScorePaths(const FPathGraph& Graph, int32 EndIndex, FPathPopulation& Paths, TConstArrayView<int32> Slots, bool bVectorized);
+};
@@ -0,0 +1,433 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathGraph.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/BoundsSearch.h"
+#include "Algo/Sort.h"
+#include "Algo/SortBy.h"
+
+void FPathGraph::SetNodeLocations(TConstArrayView<FVector> Locations)
+{
+    const int32 NumNodes = Locations.Num();
+    NodeX.SetNumUninitialized(NumNodes);
+    NodeY.SetNumUninitialized(NumNodes);
+    NodeZ.SetNumUninitialized(NumNodes);
+    for (int32 i = 0; i < NumNodes; i++)
+    {
+        NodeX[i] = Locations[i].X;
+        NodeY[i] = Locations[i].Y;
+        NodeZ[i] = Locations[i].Z;
+    }
+
+    // Any previous links refer to the old node set
+    BuildLinks(TArray<FIntPoint>());
+}
+
+bool FPathGraph::IsValidLink(int32 StartPoint, int32 EndPoint) const
+{
+    // Check if there is a valid link between the points
+    if (!IsValidNode(StartPoint) || !IsValidNode(EndPoint))
+    {
+        return false;
+    }
+
+    if (HasLinkMatrix())
+    {
+        return LinkMatrix[StartPoint * GetNumNodes() + EndPoint];
+    }
+
+    // Rows are sorted, so large graphs without the matrix binary search instead
+    return Algo::BinarySearch(GetLinks(StartPoint), EndPoint) != INDEX_NONE;
+}
+
+float FPathGraph::GetLinkLength(int32 StartPoint, int32 EndPoint) const
+{
+    if (IsValidLink(StartPoint, EndPoint))
+    {
+        // Rows are sorted in BuildLinks
+        const int32 LinkIndex = Algo::BinarySearch(GetLinks(StartPoint), EndPoint);
+        return LinkLengths[LinkOffsets[StartPoint] + LinkIndex];
+    }
+
+    return GetSegmentLength(StartPoint, EndPoint);
+}
+
+float FPathGraph::GetLinkClearance(int32 StartPoint, int32 EndPoint) const
+{
+    if (IsValidLink(StartPoint, EndPoint))
+    {
+        const int32 LinkIndex = Algo::BinarySearch(GetLinks(StartPoint), EndPoint);
+        return LinkClearances[LinkOffsets[StartPoint] + LinkIndex];
+    }
+
+    return 0.0f;
+}
+
+void FPathGraph::BuildLinks(const TArray<FIntPoint>& Links, TConstArrayView<float> Costs, TConstArrayView<float> Clearances)
+{
+    check(Costs.Num() == 0 || Costs.Num() == Links.Num());
+    check(Clearances.Num() == 0 || Clearances.Num() == Links.Num());
+    const int32 NumNodes = NodeX.Num();
+
+    // Count the degree of every node, then turn the counts into row offsets
+    LinkOffsets.Reset(NumNodes + 1);
+    LinkOffsets.AddZeroed(NumNodes + 1);
+    for (const FIntPoint& Link : Links)
+    {
+        LinkOffsets[Link.X + 1]++;
+        LinkOffsets[Link.Y + 1]++;
+    }
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        LinkOffsets[Point + 1] += LinkOffsets[Point];
+    }
+
+    // Scatter both directions of every link into its rows, costs default to the straight length
+    LinkNeighbors.SetNumUninitialized(LinkOffsets[NumNodes]);
+    LinkLengths.SetNumUninitialized(LinkOffsets[NumNodes]);
+    LinkClearances.SetNumUninitialized(LinkOffsets[NumNodes]);
+    TArray<int32> Cursor(LinkOffsets.GetData(), NumNodes);
+    for (int32 i = 0; i < Links.Num(); i++)
+    {
+        const FIntPoint& Link = Links[i];
+        const float Cost = Costs.Num() > 0 ? Costs[i] : GetSegmentLength(Link.X, Link.Y);
+        const float Clearance = Clearances.Num() > 0 ? Clearances[i] : 0.0f;
+        LinkLengths[Cursor[Link.X]] = Cost;
+        LinkClearances[Cursor[Link.X]] = Clearance;
+        LinkNeighbors[Cursor[Link.X]++] = Link.Y;
+        LinkLengths[Cursor[Link.Y]] = Cost;
+        LinkClearances[Cursor[Link.Y]] = Clearance;
+        LinkNeighbors[Cursor[Link.Y]++] = Link.X;
+    }
+
+    // Sorted rows let GetLinkLength binary search for an edge, lengths and clearances move with their neighbors
+    struct FRowLink
+    {
+        int32 Neighbor;
+        float Length;
+        float Clearance;
+    };
+    TArray<FRowLink> RowScratch;
+    LinkEnds.SetNumUninitialized(NumNodes);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        const int32 RowStart = LinkOffsets[Point];
+        const int32 RowNum = LinkOffsets[Point + 1] - RowStart;
+        LinkEnds[Point] = LinkOffsets[Point + 1];
+        RowScratch.Reset(RowNum);
+        for (int32 k = 0; k < RowNum; k++)
+        {
+            RowScratch.Add({ LinkNeighbors[RowStart + k], LinkLengths[RowStart + k], LinkClearances[RowStart + k] });
+        }
+        Algo::SortBy(RowScratch, &FRowLink::Neighbor);
+        for (int32 k = 0; k < RowNum; k++)
+        {
+            LinkNeighbors[RowStart + k] = RowScratch[k].Neighbor;
+            LinkLengths[RowStart + k] = RowScratch[k].Length;
+            LinkClearances[RowStart + k] = RowScratch[k].Clearance;
+        }
+    }
+
+    NumLinks = Links.Num();
+    DetectLinkCosts();
+    BuildLinkMatrix();
+    Version++;
+}
+
+void FPathGraph::DetectLinkCosts()
+{
+    // Costs copied from straight lengths may differ by rounding only
+    bHasLinkCosts = false;
+    for (int32 Point = 0; Point < GetNumNodes() && !bHasLinkCosts; Point++)
+    {
+        for (int32 k = LinkOffsets[Point]; k < LinkEnds[Point]; k++)
+        {
+            const float Length = GetSegmentLength(Point, LinkNeighbors[k]);
+            if (!FMath::IsNearlyEqual(LinkLengths[k], Length, FMath::Max(Length * 1e-4f, UE_KINDA_SMALL_NUMBER)))
+            {
+                bHasLinkCosts = true;
+                break;
+            }
+        }
+    }
+}
+
+void FPathGraph::BuildLinkMatrix()
+{
+    const int32 NumNodes = GetNumNodes();
+    if (NumNodes > MaxLinkMatrixNodes)
+    {
+        LinkMatrix.Empty();
+        return;
+    }
+
+    LinkMatrix.Init(false, NumNodes * NumNodes);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        for (int32 k = LinkOffsets[Point]; k < LinkEnds[Point]; k++)
+        {
+            LinkMatrix[Point * NumNodes + LinkNeighbors[k]] = true;
+        }
+    }
+}
+
+void FPathGraph::UpdateLinks(TConstArrayView<FIntPoint> Added, TConstArrayView<FIntPoint> Removed, TConstArrayView<float> AddedCosts, TConstArrayView<float> AddedClearances)
+{
+    check(AddedCosts.Num() == 0 || AddedCosts.Num() == Added.Num());
+    check(AddedClearances.Num() == 0 || AddedClearances.Num() == Added.Num());
+
+    // Links are compared lowest index first
+    auto Normalize = [](const FIntPoint& Link)
+        {
+            return FIntPoint(FMath::Min(Link.X, Link.Y), FMath::Max(Link.X, Link.Y));
+        };
+
+    TSet<FIntPoint> RemovedLinks;
+    RemovedLinks.Reserve(Removed.Num());
+    for (const FIntPoint& Link : Removed)
+    {
+        RemovedLinks.Add(Normalize(Link));
+    }
+
+    // Keep every surviving link once with its cost and clearance, lower index first
+    const int32 NumNodes = GetNumNodes();
+    TArray<FIntPoint> Links;
+    TArray<float> Costs;
+    TArray<float> Clearances;
+    Links.Reserve(GetNumLinks() + Added.Num());
+    Costs.Reserve(GetNumLinks() + Added.Num());
+    Clearances.Reserve(GetNumLinks() + Added.Num());
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        for (int32 k = LinkOffsets[Point]; k < LinkEnds[Point]; k++)
+        {
+            const FIntPoint Link(Point, LinkNeighbors[k]);
+            if (Link.X < Link.Y && !RemovedLinks.Contains(Link))
+            {
+                Links.Add(Link);
+                Costs.Add(LinkLengths[k]);
+                Clearances.Add(LinkClearances[k]);
+            }
+        }
+    }
+
+    // A duplicate in Added, or a link that already exists, is not appended twice
+    TSet<FIntPoint> AddedLinks;
+    AddedLinks.Reserve(Added.Num());
+    for (int32 i = 0; i < Added.Num(); i++)
+    {
+        const FIntPoint Link = Normalize(Added[i]);
+        bool bAlreadyAdded = false;
+        if (Link.X != Link.Y && (!IsValidLink(Link.X, Link.Y) || RemovedLinks.Contains(Link)))
+        {
+            AddedLinks.Add(Link, &bAlreadyAdded);
+            if (!bAlreadyAdded)
+            {
+                Links.Add(Link);
+                Costs.Add(AddedCosts.Num() > 0 ? AddedCosts[i] : GetSegmentLength(Link.X, Link.Y));
+                Clearances.Add(AddedClearances.Num() > 0 ? AddedClearances[i] : 0.0f);
+            }
+        }
+    }
+
+    // Rebuilding the rows is linear in the link count, only the traces were expensive
+    BuildLinks(Links, Costs, Clearances);
+}
+
+void FPathGraph::ReserveSpareLinks(TConstArrayView<int32> NumSpare)
+{
+    check(NumSpare.Num() == GetNumNodes());
+    const int32 NumNodes = GetNumNodes();
+
+    TArray<int32> NewOffsets;
+    NewOffsets.SetNumUninitialized(NumNodes + 1);
+    NewOffsets[0] = 0;
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        NewOffsets[Point + 1] = NewOffsets[Point] + (LinkEnds[Point] - LinkOffsets[Point]) + FMath::Max(NumSpare[Point], 0);
+    }
+
+    // Every row moves to its new start, the spare slots after it stay unused
+    TArray<int32> NewNeighbors;
+    TArray<float> NewLengths;
+    TArray<float> NewClearances;
+    NewNeighbors.SetNumZeroed(NewOffsets[NumNodes]);
+    NewLengths.SetNumZeroed(NewOffsets[NumNodes]);
+    NewClearances.SetNumZeroed(NewOffsets[NumNodes]);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        const int32 RowNum = LinkEnds[Point] - LinkOffsets[Point];
+        FMemory::Memcpy(NewNeighbors.GetData() + NewOffsets[Point], LinkNeighbors.GetData() + LinkOffsets[Point], RowNum * sizeof(int32));
+        FMemory::Memcpy(NewLengths.GetData() + NewOffsets[Point], LinkLengths.GetData() + LinkOffsets[Point], RowNum * sizeof(float));
+        FMemory::Memcpy(NewClearances.GetData() + NewOffsets[Point], LinkClearances.GetData() + LinkOffsets[Point], RowNum * sizeof(float));
+        LinkEnds[Point] = NewOffsets[Point] + RowNum;
+    }
+
+    LinkOffsets = MoveTemp(NewOffsets);
+    LinkNeighbors = MoveTemp(NewNeighbors);
+    LinkLengths = MoveTemp(NewLengths);
+    LinkClearances = MoveTemp(NewClearances);
+
+    // Slots moved, anything indexed by them is stale
+    Version++;
+}
+
+void FPathGraph::AddLinkInPlace(int32 StartPoint, int32 EndPoint, float Cost, float Clearance)
+{
+    check(IsValidNode(StartPoint) && IsValidNode(EndPoint) && StartPoint != EndPoint && !IsValidLink(StartPoint, EndPoint));
+
+    // Insert into the sorted row, only the row's own entries after the new one move
+    auto InsertIntoRow = [this, Cost, Clearance](int32 Point, int32 Neighbor)
+        {
+            checkf(LinkEnds[Point] < LinkOffsets[Point + 1], TEXT("Point %d has no spare link slot left."), Point);
+            const int32 Slot = LinkOffsets[Point] + Algo::UpperBound(GetLinks(Point), Neighbor);
+            for (int32 k = LinkEnds[Point]; k > Slot; k--)
+            {
+                LinkNeighbors[k] = LinkNeighbors[k - 1];
+                LinkLengths[k] = LinkLengths[k - 1];
+                LinkClearances[k] = LinkClearances[k - 1];
+            }
+            LinkNeighbors[Slot] = Neighbor;
+            LinkLengths[Slot] = Cost;
+            LinkClearances[Slot] = Clearance;
+            LinkEnds[Point]++;
+        };
+    InsertIntoRow(StartPoint, EndPoint);
+    InsertIntoRow(EndPoint, StartPoint);
+
+    if (HasLinkMatrix())
+    {
+        LinkMatrix[StartPoint * GetNumNodes() + EndPoint] = true;
+        LinkMatrix[EndPoint * GetNumNodes() + StartPoint] = true;
+    }
+
+    const float Length = GetSegmentLength(StartPoint, EndPoint);
+    bHasLinkCosts |= !FMath::IsNearlyEqual(Cost, Length, FMath::Max(Length * 1e-4f, UE_KINDA_SMALL_NUMBER));
+    NumLinks++;
+    Version++;
+}
+
+void FPathGraph::UnlinkPoint(int32 Point)
+{
+    check(IsValidNode(Point));
+
+    for (const int32 Neighbor : GetLinks(Point))
+    {
+        // Close the gap in the neighbor's row, the freed slot becomes spare
+        const int32 Slot = LinkOffsets[Neighbor] + Algo::BinarySearch(GetLinks(Neighbor), Point);
+        for (int32 k = Slot; k + 1 < LinkEnds[Neighbor]; k++)
+        {
+            LinkNeighbors[k] = LinkNeighbors[k + 1];
+            LinkLengths[k] = LinkLengths[k + 1];
+            LinkClearances[k] = LinkClearances[k + 1];
+        }
+        LinkEnds[Neighbor]--;
+
+        if (HasLinkMatrix())
+        {
+            LinkMatrix[Point * GetNumNodes() + Neighbor] = false;
+            LinkMatrix[Neighbor * GetNumNodes() + Point] = false;
+        }
+        NumLinks--;
+    }
+
+    // bHasLinkCosts stays as it was, it only selects how costs are read and the rows still hold them
+    LinkEnds[Point] = LinkOffsets[Point];
+    Version++;
+}
+
+float FPathGraph::GetPathLength(TConstArrayView<int32> Points) const
+{
+    float PathLength = 0.0f;
+    for (int32 i = 0; i < Points.Num() - 1; i++)
+    {
+        PathLength += GetSegmentLength(Points[i], Points[i + 1]);
+    }
+    return PathLength;
+}
+
+float FPathGraph::GetPathCost(TConstArrayView<int32> Points) const
+{
+    if (!bHasLinkCosts)
+    {
+        return GetPathLength(Points);
+    }
+
+    float PathCost = 0.0f;
+    for (int32 i = 0; i < Points.Num() - 1; i++)
+    {
+        PathCost += GetLinkLength(Points[i], Points[i + 1]);
+    }
+    return PathCost;
+}
+
+int32 FPathGraph::FindNearestNode(const FVector& Location) const
+{
+    int32 NearestNode = INDEX_NONE;
+    float NearestDistanceSquared = TNumericLimits<float>::Max();
+    for (int32 Point = 0; Point < GetNumNodes(); Point++)
+    {
+        const float DistanceSquared = FMath::Square(NodeX[Point] - Location.X) + FMath::Square(NodeY[Point] - Location.Y) + FMath::Square(NodeZ[Point] - Location.Z);
+        if (DistanceSquared < NearestDistanceSquared)
+        {
+            NearestDistanceSquared = DistanceSquared;
+            NearestNode = Point;
+        }
+    }
+    return NearestNode;
+}
+
+SIZE_T FPathGraph::GetAllocatedSize() const
+{
+    return NodeX.GetAllocatedSize() + NodeY.GetAllocatedSize() + NodeZ.GetAllocatedSize()
+        + LinkOffsets.GetAllocatedSize() + LinkNeighbors.GetAllocatedSize() + LinkLengths.GetAllocatedSize()
+        + LinkClearances.GetAllocatedSize() + LinkEnds.GetAllocatedSize() + LinkMatrix.GetAllocatedSize();
+}
+
+void FPathGraph::Serialize(FArchive& Ar)
+{
+    checkf(Ar.IsLoading() || LinkNeighbors.Num() == 2 * NumLinks, TEXT("A graph with spare link slots can't be saved."));
+
+    NodeX.BulkSerialize(Ar);
+    NodeY.BulkSerialize(Ar);
+    NodeZ.BulkSerialize(Ar);
+    LinkOffsets.BulkSerialize(Ar);
+    LinkNeighbors.BulkSerialize(Ar);
+    LinkLengths.BulkSerialize(Ar);
+    LinkClearances.BulkSerialize(Ar);
+
+    if (!Ar.IsLoading() || Ar.IsError())
+    {
+        return;
+    }
+
+    // Reject anything that doesn't describe a consistent CSR graph before indexing with it
+    const int32 NumNodes = NodeX.Num();
+    bool bValid = NodeY.Num() == NumNodes && NodeZ.Num() == NumNodes && LinkOffsets.Num() == NumNodes + 1
+        && LinkOffsets[0] == 0 && LinkOffsets[NumNodes] == LinkNeighbors.Num() && LinkLengths.Num() == LinkNeighbors.Num()
+        && LinkClearances.Num() == LinkNeighbors.Num();
+    for (int32 Point = 0; Point < NumNodes && bValid; Point++)
+    {
+        bValid = LinkOffsets[Point] <= LinkOffsets[Point + 1];
+    }
+    for (int32 k = 0; k < LinkNeighbors.Num() && bValid; k++)
+    {
+        bValid = IsValidNode(LinkNeighbors[k]);
+    }
+    if (!bValid)
+    {
+        Ar.SetError();
+        SetNodeLocations(TArray<FVector>());
+        return;
+    }
+
+    LinkEnds.SetNumUninitialized(NumNodes);
+    for (int32 Point = 0; Point < NumNodes; Point++)
+    {
+        LinkEnds[Point] = LinkOffsets[Point + 1];
+    }
+    NumLinks = LinkNeighbors.Num() / 2;
+    DetectLinkCosts();
+    BuildLinkMatrix();
+    Version++;
+}
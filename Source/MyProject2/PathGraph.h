@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Point graph the solvers run on: node positions as flat X/Y/Z arrays and
+// undirected links in compressed sparse row form. Plain data, no actors.
+struct MYPROJECT2_API FPathGraph
+{
+    // Graphs up to this many points also keep a NumNodes x NumNodes bit matrix (32 MB at the limit)
+    static constexpr int32 MaxLinkMatrixNodes = 16384;
+
+    // Function to replace all nodes, clears the links
+    void SetNodeLocations(TConstArrayView<FVector> Locations);
+
+    // Function to build the CSR adjacency and bit matrix from undirected links.
+    // Costs, aligned with Links, replace the straight link lengths when given, Clearances default to 0
+    void BuildLinks(const TArray<FIntPoint>& Links, TConstArrayView<float> Costs = TConstArrayView<float>(), TConstArrayView<float> Clearances = TConstArrayView<float>());
+
+    // Function to add and remove a few links without re-tracing the rest, bumps the version like BuildLinks.
+    // Surviving links keep their cost and clearance, added ones take AddedCosts or their straight length
+    // and AddedClearances or 0. A link in both lists is replaced with its added values
+    void UpdateLinks(TConstArrayView<FIntPoint> Added, TConstArrayView<FIntPoint> Removed, TConstArrayView<float> AddedCosts = TConstArrayView<float>(), TConstArrayView<float> AddedClearances = TConstArrayView<float>());
+
+    // Function to leave NumSpare[P] free slots after every point's row, so AddLinkInPlace can link it
+    // without moving the other rows. A later BuildLinks or UpdateLinks drops the spare slots again
+    void ReserveSpareLinks(TConstArrayView<int32> NumSpare);
+
+    // Functions to add one link into spare slots of both rows, and to remove every link of a point,
+    // whose slots become spare. Both only touch the rows involved and the matrix bits of their links
+    void AddLinkInPlace(int32 StartPoint, int32 EndPoint, float Cost, float Clearance = 0.0f);
+    void UnlinkPoint(int32 Point);
+
+    // Changes every time the links are rebuilt, lets callers tell stale paths apart
+    uint32 GetVersion() const { return Version; }
+
+    int32 GetNumNodes() const { return NodeX.Num(); }
+    int32 GetNumLinks() const { return NumLinks; }
+    bool IsValidNode(int32 Point) const { return Point >= 0 && Point < GetNumNodes(); }
+
+    // Neighbors of a point, sorted ascending
+    TConstArrayView<int32> GetLinks(int32 Point) const
+    {
+        return TConstArrayView<int32>(LinkNeighbors.GetData() + LinkOffsets[Point], LinkEnds[Point] - LinkOffsets[Point]);
+    }
+
+    // O(1) lookup in the link bit matrix, a binary search in the row on graphs too large for it
+    bool IsValidLink(int32 StartPoint, int32 EndPoint) const;
+    bool HasLinkMatrix() const { return LinkMatrix.Num() > 0; }
+
+    // Function to get the precomputed cost of a link, falls back to the straight distance for non-links
+    float GetLinkLength(int32 StartPoint, int32 EndPoint) const;
+
+    // True when some link costs more or less than its straight length, e.g. the abstract graph's
+    // in-cluster links. Only then do scores have to look the costs up
+    bool HasLinkCosts() const { return bHasLinkCosts; }
+
+    // Cost of one step, the straight length unless the graph has link costs
+    FORCEINLINE float GetLinkCost(int32 StartPoint, int32 EndPoint) const
+    {
+        return bHasLinkCosts ? GetLinkLength(StartPoint, EndPoint) : GetSegmentLength(StartPoint, EndPoint);
+    }
+
+    // Function to get the widest agent radius measured to fit along a link, 0 for non-links
+    float GetLinkClearance(int32 StartPoint, int32 EndPoint) const;
+
+    FVector GetNodeLocation(int32 Index) const { return FVector(NodeX[Index], NodeY[Index], NodeZ[Index]); }
+
+    // Function to find the point closest to a location, INDEX_NONE for an empty graph
+    int32 FindNearestNode(const FVector& Location) const;
+
+    // Straight-line distance between two points, read from the flat position arrays
+    FORCEINLINE float GetSegmentLength(int32 StartPoint, int32 EndPoint) const
+    {
+        const float DX = NodeX[EndPoint] - NodeX[StartPoint];
+        const float DY = NodeY[EndPoint] - NodeY[StartPoint];
+        const float DZ = NodeZ[EndPoint] - NodeZ[StartPoint];
+        return FMath::Sqrt(DX * DX + DY * DY + DZ * DZ);
+    }
+
+    // Function to rebuild LinkMatrix from the rows
+    void BuildLinkMatrix();
+
+    // Sum of the straight segments along a list of points
+    float GetPathLength(TConstArrayView<int32> Points) const;
+
+    // Sum of the step costs along a list of points, what the solvers minimize
+    float GetPathCost(TConstArrayView<int32> Points) const;
+
+    // Function to set bHasLinkCosts from the stored link lengths
+    void DetectLinkCosts();
+
+    SIZE_T GetAllocatedSize() const;
+
+    // Function to save or load the node positions, CSR links and clearances, each array in one bulk read.
+    // The link matrix is rebuilt from the rows on load and the version bumped like BuildLinks.
+    // Graphs with spare slots can't be saved
+    void Serialize(FArchive& Ar);
+
+    // Point locations as flat X/Y/Z arrays
+    TArray<float> NodeX;
+    TArray<float> NodeY;
+    TArray<float> NodeZ;
+
+    // The neighbors of point P are LinkNeighbors[LinkOffsets[P] .. LinkEnds[P]), the slots up to
+    // LinkOffsets[P + 1] are spare. LinkLengths and LinkClearances are aligned with LinkNeighbors
+    TArray<int32> LinkOffsets;
+    TArray<int32> LinkEnds;
+    TArray<int32> LinkNeighbors;
+    TArray<float> LinkLengths;
+    TArray<float> LinkClearances;
+
+    // NumNodes x NumNodes membership bits for IsValidLink, empty above MaxLinkMatrixNodes
+    TBitArray<> LinkMatrix;
+
+    uint32 Version = 0;
+    int32 NumLinks = 0;
+    bool bHasLinkCosts = false;
+};
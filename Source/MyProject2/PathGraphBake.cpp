@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathGraphBake.h"
+#include "MyProject2.h"
+#include "PathGraph.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+namespace
+{
+    constexpr uint32 BakeMagic = 0x474C5047; // "GPLG"
+
+    struct FPathGraphBakeHeader
+    {
+        uint32 Magic = BakeMagic;
+        int32 FormatVersion = FPathGraphBake::FormatVersion;
+        uint64 LayoutHash = 0;
+
+        friend FArchive& operator<<(FArchive& Ar, FPathGraphBakeHeader& Header)
+        {
+            return Ar << Header.Magic << Header.FormatVersion << Header.LayoutHash;
+        }
+    };
+}
+
+FString FPathGraphBake::GetBakePath(const UWorld* World)
+{
+    const FString MapName = FPackageName::GetShortName(UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()));
+    return FPaths::ProjectContentDir() / TEXT("GeneticPath") / MapName + TEXT(".pathgraph");
+}
+
+bool FPathGraphBake::Save(const FString& FilePath, const FPathGraph& Graph, uint64 LayoutHash)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FPathGraphBake::Save);
+
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+    if (!Writer)
+    {
+        UE_LOG(LogGeneticPath, Warning, TEXT("Could not write the link graph bake %s."), *FilePath);
+        return false;
+    }
+
+    FPathGraphBakeHeader Header;
+    Header.LayoutHash = LayoutHash;
+    *Writer << Header;
+
+    // Serialize only reads the graph when saving
+    const_cast<FPathGraph&>(Graph).Serialize(*Writer);
+    const bool bSaved = Writer->Close();
+
+    UE_LOG(LogGeneticPath, Log, TEXT("Baked %d points and %d links to %s."), Graph.GetNumNodes(), Graph.GetNumLinks(), *FilePath);
+    return bSaved;
+}
+
+bool FPathGraphBake::Load(const FString& FilePath, uint64 LayoutHash, FPathGraph& OutGraph)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FPathGraphBake::Load);
+
+    TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+    if (!Reader)
+    {
+        UE_LOG(LogGeneticPath, Log, TEXT("No link graph bake at %s."), *FilePath);
+        return false;
+    }
+
+    // The header alone tells a stale bake apart, the arrays are only read for a match
+    FPathGraphBakeHeader Header;
+    *Reader << Header;
+    if (Reader->IsError() || Header.Magic != BakeMagic || Header.FormatVersion != FormatVersion || Header.LayoutHash != LayoutHash)
+    {
+        UE_LOG(LogGeneticPath, Log, TEXT("Link graph bake %s is stale, the level layout or format changed."), *FilePath);
+        return false;
+    }
+
+    FPathGraph Graph;
+    Graph.Serialize(*Reader);
+    if (Reader->IsError())
+    {
+        UE_LOG(LogGeneticPath, Warning, TEXT("Link graph bake %s is damaged."), *FilePath);
+        return false;
+    }
+
+    // Keep the caller's version counter moving so cached paths from an older graph can't match
+    Graph.Version = FMath::Max(Graph.Version, OutGraph.Version + 1);
+    OutGraph = MoveTemp(Graph);
+    return true;
+}
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPathGraph;
+class UWorld;
+
+// Link graph baked to a small binary file per level, so BeginPlay can skip tracing every pair.
+// The header carries a hash of the point and barrier layout it was traced from, a bake whose
+// hash no longer matches the level is ignored and traced again
+struct MYPROJECT2_API FPathGraphBake
+{
+    // Bumped whenever the file layout or FPathGraph::Serialize changes, older bakes are then ignored
+    static constexpr int32 FormatVersion = 2;
+
+    // Content/GeneticPath/<MapName>.pathgraph, the same file for the editor world and PIE
+    static FString GetBakePath(const UWorld* World);
+
+    // Function to write a graph with the layout hash it was traced from
+    static bool Save(const FString& FilePath, const FPathGraph& Graph, uint64 LayoutHash);
+
+    // Function to load a bake, false without touching OutGraph if it is missing, stale or damaged
+    static bool Load(const FString& FilePath, uint64 LayoutHash, FPathGraph& OutGraph);
+};
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathPopulation.h"
+#include "Algo/StableSort.h"
+
+uint64 FPathPopulation::HashPath(TConstArrayView<int32> Points)
+{
+    uint64 Hash = 0;
+    for (int32 i = 0; i < Points.Num(); i++)
+    {
+        Hash ^= HashPoint(Points[i], i);
+    }
+    return Hash;
+}
+
+void FPathPopulation::Reset(int32 MaxPaths, int32 MaxPathLength)
+{
+    Stride = MaxPathLength;
+    for (int32 Buffer = 0; Buffer < 2; Buffer++)
+    {
+        Genes[Buffer].SetNumUninitialized(MaxPaths * Stride);
+        Lengths[Buffer].SetNumZeroed(MaxPaths);
+        Hashes[Buffer].SetNumZeroed(MaxPaths);
+        Fitness[Buffer].SetNumZeroed(MaxPaths);
+    }
+    Ranking.SetNumUninitialized(MaxPaths);
+
+    NumPaths = 0;
+    NextNumPaths = 0;
+    Current = 0;
+}
+
+void FPathPopulation::SortByFitness()
+{
+    for (int32 i = 0; i < NumPaths; i++)
+    {
+        Ranking[i] = i;
+    }
+
+    // Stable so ties keep a deterministic order, only the indices move
+    const TArray<float>& CurrentFitness = Fitness[Current];
+    Algo::StableSort(TArrayView<int32>(Ranking.GetData(), NumPaths), [&CurrentFitness](int32 A, int32 B) { return CurrentFitness[A] > CurrentFitness[B]; });
+}
+
+void FPathPopulation::BeginNextGeneration(int32 InNumPaths)
+{
+    check(InNumPaths <= GetMaxPaths());
+    NextNumPaths = InNumPaths;
+}
+
+void FPathPopulation::CopyToNext(int32 Index, int32 SourceIndex)
+{
+    const TConstArrayView<int32> Source = GetPath(SourceIndex);
+    FMemory::Memcpy(GetNextPathBuffer(Index).GetData(), Source.GetData(), Source.Num() * sizeof(int32));
+    SetNextPath(Index, Source.Num(), GetHash(SourceIndex), GetFitness(SourceIndex));
+}
+
+void FPathPopulation::SwapGenerations()
+{
+    Current = 1 - Current;
+    NumPaths = NextNumPaths;
+}
+
+int32 FPathPopulation::AddPaths(int32 InNumPaths)
+{
+    check(NumPaths + InNumPaths <= GetMaxPaths());
+    const int32 FirstNewPath = NumPaths;
+    NumPaths += InNumPaths;
+    for (int32 i = FirstNewPath; i < NumPaths; i++)
+    {
+        Lengths[Current][i] = 0;
+        Hashes[Current][i] = 0;
+        Fitness[Current][i] = UnscoredFitness;
+    }
+    return FirstNewPath;
+}
+
+void FPathPopulation::SetPath(int32 Index, TConstArrayView<int32> Points)
+{
+    check(Points.Num() <= Stride);
+    FMemory::Memcpy(GetPathBuffer(Index).GetData(), Points.GetData(), Points.Num() * sizeof(int32));
+    SetPathLength(Index, Points.Num());
+}
+
+void FPathPopulation::SetPathLength(int32 Index, int32 Length)
+{
+    Lengths[Current][Index] = Length;
+    Hashes[Current][Index] = HashPath(GetPath(Index));
+    Fitness[Current][Index] = UnscoredFitness;
+}
+
+SIZE_T FPathPopulation::GetAllocatedSize() const
+{
+    SIZE_T Size = Ranking.GetAllocatedSize();
+    for (int32 Buffer = 0; Buffer < 2; Buffer++)
+    {
+        Size += Genes[Buffer].GetAllocatedSize() + Lengths[Buffer].GetAllocatedSize()
+            + Hashes[Buffer].GetAllocatedSize() + Fitness[Buffer].GetAllocatedSize();
+    }
+    return Size;
+}
+
+void FPathFitnessCache::Reset(int32 InCapacity)
+{
+    Capacity = InCapacity;
+    Entries.Reset();
+    Entries.Reserve(Capacity);
+    SeenHashes.Reset();
+}
+
+void FPathFitnessCache::Add(uint64 Hash, float Fitness)
+{
+    if (Entries.Num() >= Capacity && !Entries.Contains(Hash))
+    {
+        Entries.Reset();
+    }
+    Entries.Add(Hash, Fitness);
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/HashTable.h"
+
+// Paths of one population in a flat gene buffer, every path gets a fixed-stride slot.
+// The current and next generations live in two buffers that swap instead of copying,
+// so after Reset a generation step does no heap allocation.
+class MYPROJECT2_API FPathPopulation
+{
+public:
+    // Fitness of a slot nobody has scored yet
+    static constexpr float UnscoredFitness = -1.0f;
+
+    // Order-dependent path hash, the XOR of one term per (point, position) so a single
+    // changed point can be swapped out without rehashing the whole path
+    static uint64 HashPoint(int32 Point, int32 Position)
+    {
+        return MurmurFinalize64((static_cast<uint64>(static_cast<uint32>(Position)) << 32) | static_cast<uint32>(Point));
+    }
+    static uint64 HashPath(TConstArrayView<int32> Points);
+
+    // Function to size both buffers for up to MaxPaths paths of at most MaxPathLength points, drops all paths
+    void Reset(int32 MaxPaths, int32 MaxPathLength);
+
+    int32 Num() const { return NumPaths; }
+    int32 GetMaxPaths() const { return Lengths[0].Num(); }
+    int32 GetMaxPathLength() const { return Stride; }
+
+    // Paths of the current generation
+    TConstArrayView<int32> GetPath(int32 Index) const
+    {
+        return TConstArrayView<int32>(Genes[Current].GetData() + Index * Stride, Lengths[Current][Index]);
+    }
+
+    uint64 GetHash(int32 Index) const { return Hashes[Current][Index]; }
+    float GetFitness(int32 Index) const { return Fitness[Current][Index]; }
+    void SetFitness(int32 Index, float InFitness) { Fitness[Current][Index] = InFitness; }
+    bool IsScored(int32 Index) const { return GetFitness(Index) >= 0.0f; }
+
+    // Slot of the Rank-th best path, valid after SortByFitness
+    int32 GetRanked(int32 Rank) const { return Ranking[Rank]; }
+    void SortByFitness();
+
+    // Function to start writing a next generation of NumPaths paths
+    void BeginNextGeneration(int32 InNumPaths);
+
+    // Whole slot of a next-generation path, write the points and then call SetNextPath
+    TArrayView<int32> GetNextPathBuffer(int32 Index)
+    {
+        return TArrayView<int32>(Genes[1 - Current].GetData() + Index * Stride, Stride);
+    }
+    void SetNextPath(int32 Index, int32 Length, uint64 Hash, float InFitness = UnscoredFitness)
+    {
+        Lengths[1 - Current][Index] = Length;
+        Hashes[1 - Current][Index] = Hash;
+        Fitness[1 - Current][Index] = InFitness;
+    }
+
+    // Next-generation paths, readable once SetNextPath was called for them
+    TConstArrayView<int32> GetNextPath(int32 Index) const
+    {
+        return TConstArrayView<int32>(Genes[1 - Current].GetData() + Index * Stride, Lengths[1 - Current][Index]);
+    }
+    uint64 GetNextHash(int32 Index) const { return Hashes[1 - Current][Index]; }
+    int32 GetNextNum() const { return NextNumPaths; }
+
+    // Function to copy a current path with its hash and fitness into a next-generation slot
+    void CopyToNext(int32 Index, int32 SourceIndex);
+
+    // Function to make the next generation current, unscored slots are left for the caller to evaluate
+    void SwapGenerations();
+
+    // Function to grow the current generation by InNumPaths empty slots, returns the first new slot
+    int32 AddPaths(int32 InNumPaths);
+
+    // Functions to overwrite a current path, the hash is recomputed and the fitness reset
+    void SetPath(int32 Index, TConstArrayView<int32> Points);
+    TArrayView<int32> GetPathBuffer(int32 Index) { return TArrayView<int32>(Genes[Current].GetData() + Index * Stride, Stride); }
+    void SetPathLength(int32 Index, int32 Length);
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    TArray<int32> Genes[2];
+    TArray<int32> Lengths[2];
+    TArray<uint64> Hashes[2];
+    TArray<float> Fitness[2];
+    TArray<int32> Ranking;
+
+    int32 Stride = 0;
+    int32 NumPaths = 0;
+    int32 NextNumPaths = 0;
+    int32 Current = 0;
+};
+
+// Bounded map from path hash to fitness, one per island so workers never share it.
+// Cleared when it fills up, which keeps its allocation and stays cheaper than LRU bookkeeping.
+class MYPROJECT2_API FPathFitnessCache
+{
+public:
+    void Reset(int32 InCapacity);
+
+    const float* Find(uint64 Hash) const { return Entries.Find(Hash); }
+    void Add(uint64 Hash, float Fitness);
+
+    // Scratch set for duplicate checks within one generation, kept here to reuse its allocation
+    TSet<uint64> SeenHashes;
+
+private:
+    TMap<uint64, float> Entries;
+    int32 Capacity = 0;
+};
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "PathPopulation.h"
+#include "PathSelection.generated.h"
+
+// How the GA picks parents from a ranked population
+UENUM(BlueprintType)
+enum class EGeneticSelectionType : uint8
+{
+    // Every path equally likely, no selection pressure
+    Uniform,
+    // Best of TournamentSize random paths
+    Tournament,
+    // Linear ranking, the best path is picked N times as often as the worst
+    Rank,
+    // Fitness proportional, drawn from an alias table in constant time
+    Roulette,
+};
+
+// Walker's alias table: after an O(N) build, one draw costs a random index and one compare
+struct FPathAliasTable
+{
+    // Function to build the table from non-negative weights, all zero weights give a uniform table
+    void Build(TConstArrayView<float> Weights)
+    {
+        const int32 Num = Weights.Num();
+        Probability.SetNumUninitialized(Num);
+        Alias.SetNumUninitialized(Num);
+
+        double Total = 0.0;
+        for (const float Weight : Weights)
+        {
+            Total += FMath::Max(Weight, 0.0f);
+        }
+
+        // Scaled so the average weight is 1, then every under-full column is topped up from an over-full one
+        TArray<int32, TInlineAllocator<64>> Small;
+        TArray<int32, TInlineAllocator<64>> Large;
+        for (int32 i = 0; i < Num; i++)
+        {
+            Probability[i] = Total > 0.0 ? static_cast<float>(FMath::Max(Weights[i], 0.0f) * Num / Total) : 1.0f;
+            Alias[i] = i;
+            (Probability[i] < 1.0f ? Small : Large).Add(i);
+        }
+        while (Small.Num() > 0 && Large.Num() > 0)
+        {
+            const int32 Under = Small.Pop(EAllowShrinking::No);
+            const int32 Over = Large.Last();
+            Alias[Under] = Over;
+            Probability[Over] -= 1.0f - Probability[Under];
+            if (Probability[Over] < 1.0f)
+            {
+                Small.Add(Large.Pop(EAllowShrinking::No));
+            }
+        }
+
+        // What is left over is full up to rounding
+        for (const int32 i : Small)
+        {
+            Probability[i] = 1.0f;
+        }
+        for (const int32 i : Large)
+        {
+            Probability[i] = 1.0f;
+        }
+    }
+
+    int32 Num() const { return Probability.Num(); }
+
+    int32 Sample(FRandomStream& Random) const
+    {
+        const int32 Column = Random.RandRange(0, Probability.Num() - 1);
+        return Random.FRand() < Probability[Column] ? Column : Alias[Column];
+    }
+
+private:
+    TArray<float, TInlineAllocator<64>> Probability;
+    TArray<int32, TInlineAllocator<64>> Alias;
+};
+
+// Selection policies for FGeneticSolver. Prepare runs once per generation on one thread,
+// Select then runs concurrently for every child and must only read the policy
+
+struct FUniformSelection
+{
+    void Prepare(const FPathPopulation& InPaths) { NumPaths = InPaths.Num(); }
+    int32 Select(FRandomStream& Random) const { return Random.RandRange(0, NumPaths - 1); }
+
+private:
+    int32 NumPaths = 0;
+};
+
+struct FTournamentSelection
+{
+    explicit FTournamentSelection(int32 InTournamentSize) : TournamentSize(FMath::Max(1, InTournamentSize)) {}
+
+    void Prepare(const FPathPopulation& InPaths) { Paths = &InPaths; }
+
+    int32 Select(FRandomStream& Random) const
+    {
+        int32 Best = Random.RandRange(0, Paths->Num() - 1);
+        for (int32 Round = 1; Round < TournamentSize; Round++)
+        {
+            const int32 Challenger = Random.RandRange(0, Paths->Num() - 1);
+            if (Paths->GetFitness(Challenger) > Paths->GetFitness(Best))
+            {
+                Best = Challenger;
+            }
+        }
+        return Best;
+    }
+
+private:
+    const FPathPopulation* Paths = nullptr;
+    int32 TournamentSize;
+};
+
+struct FRankSelection
+{
+    void Prepare(const FPathPopulation& InPaths)
+    {
+        Paths = &InPaths;
+
+        // The weights only depend on the population size, so the table is rebuilt only when that changes
+        if (Ranks.Num() != InPaths.Num())
+        {
+            TArray<float, TInlineAllocator<64>> Weights;
+            for (int32 Rank = 0; Rank < InPaths.Num(); Rank++)
+            {
+                Weights.Add(static_cast<float>(InPaths.Num() - Rank));
+            }
+            Ranks.Build(Weights);
+        }
+    }
+
+    int32 Select(FRandomStream& Random) const { return Paths->GetRanked(Ranks.Sample(Random)); }
+
+private:
+    const FPathPopulation* Paths = nullptr;
+    FPathAliasTable Ranks;
+};
+
+struct FRouletteSelection
+{
+    void Prepare(const FPathPopulation& InPaths)
+    {
+        TArray<float, TInlineAllocator<64>> Weights;
+        Weights.SetNumUninitialized(InPaths.Num());
+        for (int32 i = 0; i < InPaths.Num(); i++)
+        {
+            Weights[i] = InPaths.GetFitness(i);
+        }
+        Slots.Build(Weights);
+    }
+
+    int32 Select(FRandomStream& Random) const { return Slots.Sample(Random); }
+
+private:
+    FPathAliasTable Slots;
+};
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PathSolver.h"
+#include "GeneticSolver.h"
+#include "HierarchicalPathSolver.h"
+#include "PathGraph.h"
+#include "ShortestPathSolver.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarGeneticPathAutoExactNodeLimit(
+    TEXT("GeneticPath.AutoExactNodeLimit"),
+    50000,
+    TEXT("Largest graph the Auto solver strategy answers with an exact A* search, larger graphs use the hierarchical solver."));
+
+EPathSolverType ResolvePathSolverType(EPathSolverType Type, const FPathGraph& Graph)
+{
+    if (Type != EPathSolverType::Auto)
+    {
+        return Type;
+    }
+
+    // Exact search touches every point in the worst case, the hierarchical search only the portals
+    // and the clusters along the way
+    return Graph.GetNumNodes() <= CVarGeneticPathAutoExactNodeLimit.GetValueOnAnyThread() ? EPathSolverType::AStar : EPathSolverType::Hierarchical;
+}
+
+TUniquePtr<IPathSolver> MakePathSolver(EPathSolverType Type, const FPathGraph& Graph)
+{
+    switch (ResolvePathSolverType(Type, Graph))
+    {
+    case EPathSolverType::AStar:
+        return MakeUnique<FAStarSolver>(Graph);
+    case EPathSolverType::BidirectionalDijkstra:
+        return MakeUnique<FBidirectionalDijkstraSolver>(Graph);
+    case EPathSolverType::Hierarchical:
+        return MakeUnique<FHierarchicalSolver>(Graph);
+    default:
+        return MakeUnique<FGeneticSolver>(Graph);
+    }
+}
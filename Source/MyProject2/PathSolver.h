@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+#include "PathSolver.generated.h"
+
+struct FPath;
+struct FPathGraph;
+struct FGeneticSolverSettings;
+
+// Called on the solving thread with the best path so far, whenever it improves
+DECLARE_DELEGATE_OneParam(FOnPathSolveProgress, const FPath& /*BestPath*/);
+
+// Search strategies that can answer a path request
+UENUM(BlueprintType)
+enum class EPathSolverType : uint8
+{
+    // Exact search on graphs up to GeneticPath.AutoExactNodeLimit points, the hierarchical search above
+    Auto,
+    Genetic,
+    AStar UMETA(DisplayName = "A*"),
+    BidirectionalDijkstra UMETA(DisplayName = "Bidirectional Dijkstra"),
+    // Search between cluster portals first, then refine inside the clusters
+    Hierarchical,
+};
+
+// A search strategy on a FPathGraph. Solve runs on any thread and must poll the cancel flag
+class MYPROJECT2_API IPathSolver
+{
+public:
+    virtual ~IPathSolver() = default;
+
+    // Function to find a path between two graph points, an empty path if there is none or it was cancelled
+    virtual FPath Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested) = 0;
+
+    // Function to solve again after the graph or the start and end changed, reusing what the last solve
+    // left behind where the strategy can. Solves from scratch by default
+    virtual FPath Replan(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested)
+    {
+        return Solve(StartIndex, EndIndex, Seed, bCancelRequested);
+    }
+
+    virtual EPathSolverType GetType() const = 0;
+
+    // Wall time of the last Solve
+    virtual double GetLastSolveSeconds() const = 0;
+
+    // Settings of the GA this solver runs, if it runs one
+    virtual FGeneticSolverSettings* GetGeneticSettings() { return nullptr; }
+
+    // Bound before Solve to get intermediate paths, solvers that only find one answer never call it
+    FOnPathSolveProgress OnProgress;
+};
+
+// Function to turn Auto into a concrete strategy for a graph
+MYPROJECT2_API EPathSolverType ResolvePathSolverType(EPathSolverType Type, const FPathGraph& Graph);
+
+// Function to create the solver for a strategy, Auto is resolved against the graph first
+MYPROJECT2_API TUniquePtr<IPathSolver> MakePathSolver(EPathSolverType Type, const FPathGraph& Graph);
@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ShortestPathSolver.h"
+#include "MyProject2.h"
+#include "GeneticSolver.h"
+#include "PathGraph.h"
+#include "Algo/Reverse.h"
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_CYCLE_STAT(TEXT("A* Solve"), STAT_GeneticPath_AStar, STATGROUP_GeneticPath);
+DECLARE_CYCLE_STAT(TEXT("Bidirectional Dijkstra Solve"), STAT_GeneticPath_BidirectionalDijkstra, STATGROUP_GeneticPath);
+
+namespace
+{
+    // Points expanded between two looks at the cancel flag
+    constexpr int32 CancelCheckInterval = 1024;
+
+    const auto OpenEntryLess = [](const auto& A, const auto& B) { return A.Priority < B.Priority; };
+
+    // Exact paths are scored like a GA path that reached its end
+    void FinishPath(FPath& Path, const FPathGraph& Graph)
+    {
+        const float PathLength = Graph.GetPathCost(Path.PathPoints);
+        Path.Fitness = PathLength > 0.0f ? 1.0f / PathLength : 0.0f;
+    }
+}
+
+void FShortestPathFrontier::Begin(int32 NumNodes)
+{
+    if (Cost.Num() != NumNodes)
+    {
+        Cost.SetNumUninitialized(NumNodes);
+        Parent.SetNumUninitialized(NumNodes);
+        ReachedStamp.Init(0, NumNodes);
+        ClosedStamp.Init(0, NumNodes);
+        SearchId = 0;
+    }
+
+    // Stamps wrapped around, old ones could look current again
+    if (++SearchId == 0)
+    {
+        ReachedStamp.Init(0, NumNodes);
+        ClosedStamp.Init(0, NumNodes);
+        SearchId = 1;
+    }
+    Open.Reset();
+}
+
+void FShortestPathFrontier::Reach(int32 Point, float InCost, int32 InParent, float Priority)
+{
+    Cost[Point] = InCost;
+    Parent[Point] = InParent;
+    ReachedStamp[Point] = SearchId;
+    Open.HeapPush(FOpenEntry{ Priority, Point }, OpenEntryLess);
+}
+
+void FShortestPathFrontier::SkipClosed()
+{
+    // A point is queued again every time a cheaper way to it shows up, only its first pop counts
+    FOpenEntry Entry;
+    while (Open.Num() > 0 && IsClosed(Open.HeapTop().Point))
+    {
+        Open.HeapPop(Entry, OpenEntryLess, EAllowShrinking::No);
+    }
+}
+
+bool FShortestPathFrontier::HasOpen()
+{
+    SkipClosed();
+    return Open.Num() > 0;
+}
+
+float FShortestPathFrontier::PeekPriority()
+{
+    SkipClosed();
+    return Open.Num() > 0 ? Open.HeapTop().Priority : TNumericLimits<float>::Max();
+}
+
+bool FShortestPathFrontier::PopNext(int32& OutPoint, float& OutCost)
+{
+    SkipClosed();
+    if (Open.Num() == 0)
+    {
+        return false;
+    }
+
+    FOpenEntry Entry;
+    Open.HeapPop(Entry, OpenEntryLess, EAllowShrinking::No);
+    ClosedStamp[Entry.Point] = SearchId;
+    OutPoint = Entry.Point;
+    OutCost = Cost[Entry.Point];
+    return true;
+}
+
+void FShortestPathFrontier::AppendChain(int32 Point, TArray<int32>& OutPoints) const
+{
+    for (; Point != INDEX_NONE; Point = Parent[Point])
+    {
+        OutPoints.Add(Point);
+    }
+}
+
+FPath FAStarSolver::Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FAStarSolver::Solve);
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_AStar);
+
+    const double SolveStartTime = FPlatformTime::Seconds();
+    FPath Path;
+    if (!Graph.IsValidNode(StartIndex) || !Graph.IsValidNode(EndIndex))
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Start or End point is not in the graph! StartIndex: %d, EndIndex: %d"), StartIndex, EndIndex);
+        return Path;
+    }
+
+    Frontier.Begin(Graph.GetNumNodes());
+    Frontier.Reach(StartIndex, 0.0f, INDEX_NONE, Graph.GetSegmentLength(StartIndex, EndIndex));
+
+    int32 NumExpanded = 0;
+    int32 Point;
+    float PointCost;
+    while (Frontier.PopNext(Point, PointCost))
+    {
+        if (Point == EndIndex)
+        {
+            Frontier.AppendChain(EndIndex, Path.PathPoints);
+            Algo::Reverse(Path.PathPoints);
+            FinishPath(Path, Graph);
+            break;
+        }
+
+        if (++NumExpanded % CancelCheckInterval == 0 && bCancelRequested.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        for (int32 Link = Graph.LinkOffsets[Point]; Link < Graph.LinkEnds[Point]; Link++)
+        {
+            const int32 Neighbor = Graph.LinkNeighbors[Link];
+            const float NeighborCost = PointCost + Graph.LinkLengths[Link];
+            if (!Frontier.IsClosed(Neighbor) && NeighborCost < Frontier.GetCost(Neighbor))
+            {
+                Frontier.Reach(Neighbor, NeighborCost, Point, NeighborCost + Graph.GetSegmentLength(Neighbor, EndIndex));
+            }
+        }
+    }
+
+    UE_LOG(LogGeneticPath, Verbose, TEXT("A* %d -> %d expanded %d points, %s."), StartIndex, EndIndex, NumExpanded, Path.PathPoints.Num() > 0 ? TEXT("found a path") : TEXT("no path"));
+    LastSolveSeconds = FPlatformTime::Seconds() - SolveStartTime;
+    return Path;
+}
+
+FPath FBidirectionalDijkstraSolver::Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested)
+{
+    TRACE_CPUPROFILER_EVENT_SCOPE(FBidirectionalDijkstraSolver::Solve);
+    SCOPE_CYCLE_COUNTER(STAT_GeneticPath_BidirectionalDijkstra);
+
+    const double SolveStartTime = FPlatformTime::Seconds();
+    FPath Path;
+    if (!Graph.IsValidNode(StartIndex) || !Graph.IsValidNode(EndIndex))
+    {
+        UE_LOG(LogGeneticPath, Error, TEXT("Start or End point is not in the graph! StartIndex: %d, EndIndex: %d"), StartIndex, EndIndex);
+        return Path;
+    }
+
+    Forward.Begin(Graph.GetNumNodes());
+    Backward.Begin(Graph.GetNumNodes());
+    Forward.Reach(StartIndex, 0.0f, INDEX_NONE, 0.0f);
+    Backward.Reach(EndIndex, 0.0f, INDEX_NONE, 0.0f);
+
+    float BestCost = StartIndex == EndIndex ? 0.0f : TNumericLimits<float>::Max();
+    int32 MeetingPoint = StartIndex == EndIndex ? StartIndex : INDEX_NONE;
+    int32 NumExpanded = 0;
+    bool bCancelled = false;
+    while (Forward.HasOpen() && Backward.HasOpen())
+    {
+        // Every path not found yet costs at least both frontier minimums together
+        const float ForwardMin = Forward.PeekPriority();
+        const float BackwardMin = Backward.PeekPriority();
+        if (ForwardMin + BackwardMin >= BestCost)
+        {
+            break;
+        }
+
+        if (++NumExpanded % CancelCheckInterval == 0 && bCancelRequested.load(std::memory_order_relaxed))
+        {
+            bCancelled = true;
+            break;
+        }
+
+        // Grow the side that is cheaper to grow, links are symmetric so both use the same rows
+        const bool bGrowForward = ForwardMin <= BackwardMin;
+        FShortestPathFrontier& Frontier = bGrowForward ? Forward : Backward;
+        const FShortestPathFrontier& Other = bGrowForward ? Backward : Forward;
+
+        int32 Point;
+        float PointCost;
+        Frontier.PopNext(Point, PointCost);
+        for (int32 Link = Graph.LinkOffsets[Point]; Link < Graph.LinkEnds[Point]; Link++)
+        {
+            const int32 Neighbor = Graph.LinkNeighbors[Link];
+            const float NeighborCost = PointCost + Graph.LinkLengths[Link];
+            if (Frontier.IsClosed(Neighbor))
+            {
+                continue;
+            }
+
+            if (NeighborCost < Frontier.GetCost(Neighbor))
+            {
+                Frontier.Reach(Neighbor, NeighborCost, Point, NeighborCost);
+            }
+
+            // Both searches reached this point, a candidate for the best meeting
+            if (Other.IsReached(Neighbor) && Frontier.GetCost(Neighbor) + Other.GetCost(Neighbor) < BestCost)
+            {
+                BestCost = Frontier.GetCost(Neighbor) + Other.GetCost(Neighbor);
+                MeetingPoint = Neighbor;
+            }
+        }
+    }
+
+    if (MeetingPoint != INDEX_NONE && !bCancelled)
+    {
+        // Start..meeting from the forward parents, then meeting..end from the backward ones
+        Forward.AppendChain(MeetingPoint, Path.PathPoints);
+        Algo::Reverse(Path.PathPoints);
+        const int32 MeetingIndex = Path.PathPoints.Num() - 1;
+        Backward.AppendChain(MeetingPoint, Path.PathPoints);
+        Path.PathPoints.RemoveAt(MeetingIndex);
+        FinishPath(Path, Graph);
+    }
+
+    UE_LOG(LogGeneticPath, Verbose, TEXT("Bidirectional Dijkstra %d -> %d expanded %d points, %s."), StartIndex, EndIndex, NumExpanded, Path.PathPoints.Num() > 0 ? TEXT("found a path") : TEXT("no path"));
+    LastSolveSeconds = FPlatformTime::Seconds() - SolveStartTime;
+    return Path;
+}
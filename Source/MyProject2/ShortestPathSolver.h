@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathSolver.h"
+
+struct FPathGraph;
+
+// One direction of a Dijkstra-style search. Point state is stamped with the search id,
+// so starting a search on a large graph doesn't clear anything
+struct FShortestPathFrontier
+{
+    // Function to start a new search, the arrays only grow on the first one
+    void Begin(int32 NumNodes);
+
+    bool IsReached(int32 Point) const { return ReachedStamp[Point] == SearchId; }
+    bool IsClosed(int32 Point) const { return ClosedStamp[Point] == SearchId; }
+    float GetCost(int32 Point) const { return IsReached(Point) ? Cost[Point] : TNumericLimits<float>::Max(); }
+
+    // Function to record a cheaper way to a point and queue it with a priority
+    void Reach(int32 Point, float InCost, int32 InParent, float Priority);
+
+    // Functions for the open list, closed points left in it are skipped
+    bool HasOpen();
+    float PeekPriority();
+    bool PopNext(int32& OutPoint, float& OutCost);
+
+    // Function to append the points from Point back to where the search started
+    void AppendChain(int32 Point, TArray<int32>& OutPoints) const;
+
+private:
+    struct FOpenEntry
+    {
+        float Priority;
+        int32 Point;
+    };
+
+    void SkipClosed();
+
+    TArray<float> Cost;
+    TArray<int32> Parent;
+    TArray<uint32> ReachedStamp;
+    TArray<uint32> ClosedStamp;
+    TArray<FOpenEntry> Open;
+    uint32 SearchId = 0;
+};
+
+// Exact shortest path with a straight-line distance heuristic, admissible since link costs are their lengths
+class MYPROJECT2_API FAStarSolver : public IPathSolver
+{
+public:
+    explicit FAStarSolver(const FPathGraph& InGraph) : Graph(InGraph) {}
+
+    virtual FPath Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested) override;
+    virtual EPathSolverType GetType() const override { return EPathSolverType::AStar; }
+    virtual double GetLastSolveSeconds() const override { return LastSolveSeconds; }
+
+private:
+    const FPathGraph& Graph;
+    FShortestPathFrontier Frontier;
+    double LastSolveSeconds = 0.0;
+};
+
+// Exact shortest path grown from both ends at once, stops when the frontiers can't improve the best meeting
+class MYPROJECT2_API FBidirectionalDijkstraSolver : public IPathSolver
+{
+public:
+    explicit FBidirectionalDijkstraSolver(const FPathGraph& InGraph) : Graph(InGraph) {}
+
+    virtual FPath Solve(int32 StartIndex, int32 EndIndex, int32 Seed, const std::atomic<bool>& bCancelRequested) override;
+    virtual EPathSolverType GetType() const override { return EPathSolverType::BidirectionalDijkstra; }
+    virtual double GetLastSolveSeconds() const override { return LastSolveSeconds; }
+
+private:
+    const FPathGraph& Graph;
+    FShortestPathFrontier Forward;
+    FShortestPathFrontier Backward;
+    double LastSolveSeconds = 0.0;
+};